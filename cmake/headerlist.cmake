@@ -2,4 +2,23 @@ set(headers ${headers}
 	include/Utils.h
 	include/PCH.h
 	include/Settings.h
+	include/ConcurrentFormSet.h
+	include/FrozenFormSet.h
+	include/FormListParser.h
+	include/FormListCache.h
+	include/TransferPlanner.h
+	include/Metrics.h
+	include/TaskPool.h
+	include/RuleProgram.h
+	include/OutfitCache.h
+	include/Events.h
+	include/InventoryVisitor.h
+	include/TransferQueue.h
+	include/TransferWorker.h
+	include/TransferRequests.h
+	include/ContainerIndex.h
+	include/StorageRoutes.h
+	include/ScratchBuffers.h
+	include/TransferTrace.h
+	include/TransferRecorder.h
 )
@@ -2,4 +2,17 @@ set(sources ${sources}
 	src/plugin.cpp
 	src/Utils.cpp
 	src/Settings.cpp
+	src/FormListCache.cpp
+	src/FormListLoader.cpp
+	src/Metrics.cpp
+	src/TaskPool.cpp
+	src/RuleProgram.cpp
+	src/OutfitCache.cpp
+	src/Events.cpp
+	src/TransferQueue.cpp
+	src/TransferWorker.cpp
+	src/TransferRequests.cpp
+	src/ContainerIndex.cpp
+	src/StorageRoutes.cpp
+	src/TransferRecorder.cpp
 )
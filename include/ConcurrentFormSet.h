@@ -0,0 +1,148 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Read-mostly FormID set with wait-free lookups.
+// Readers probe an open-addressing table published through an atomic pointer.
+// Writers queue new ids and, once a batch is full (or on Publish()), write them into the free slots of the current
+// table; readers see each slot either empty or filled. Only when the table would pass half full is a larger one built
+// and published. The table it replaces is freed at a later publication once no reader is inside the set.
+class ConcurrentFormSet {
+public:
+    static constexpr std::size_t kPublishBatch = 64;
+
+    ConcurrentFormSet() = default;
+    ConcurrentFormSet(const ConcurrentFormSet&) = delete;
+    ConcurrentFormSet& operator=(const ConcurrentFormSet&) = delete;
+
+    [[nodiscard]] bool contains(const FormID a_formid) const noexcept {
+        if (a_formid == 0) {
+            return false;
+        }
+        const ReadGuard guard(_readers);
+        const auto table = _table.load();
+        if (!table) {
+            return false;
+        }
+        const auto mask = table->capacity - 1;
+        for (auto i = Hash(a_formid) & mask;; i = (i + 1) & mask) {
+            const auto slot = table->slots[i].load(std::memory_order_acquire);
+            if (slot == a_formid) return true;
+            if (slot == 0) return false;
+        }
+    }
+
+    // The id becomes visible to readers with the next publication.
+    void insert(const FormID a_formid) {
+        if (a_formid == 0) return;
+        std::lock_guard lock(_writeMutex);
+        _pending.push_back(a_formid);
+        if (_pending.size() >= kPublishBatch) {
+            PublishLocked();
+        }
+    }
+
+    void Publish() {
+        std::lock_guard lock(_writeMutex);
+        PublishLocked();
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        const ReadGuard guard(_readers);
+        const auto table = _table.load();
+        return table ? table->count.load(std::memory_order_relaxed) : 0;
+    }
+
+private:
+    struct Table {
+        explicit Table(const std::size_t a_capacity) : capacity(a_capacity), slots(std::make_unique<std::atomic<FormID>[]>(a_capacity)) {}
+
+        std::size_t capacity;                        // power of two
+        std::unique_ptr<std::atomic<FormID>[]> slots;  // 0 marks an empty slot
+        std::atomic<std::size_t> count{0};
+    };
+
+    // Counts readers inside the set, so a writer knows when nothing can still hold a replaced table
+    class ReadGuard {
+    public:
+        explicit ReadGuard(std::atomic<std::uint32_t>& a_readers) noexcept : _readers(a_readers) { _readers.fetch_add(1); }
+        ~ReadGuard() { _readers.fetch_sub(1, std::memory_order_release); }
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+    private:
+        std::atomic<std::uint32_t>& _readers;
+    };
+
+    static std::size_t Hash(const FormID a_formid) noexcept {
+        // Fibonacci hashing spreads the mod index byte over the low bits
+        return static_cast<std::size_t>((static_cast<std::uint64_t>(a_formid) * 0x9E3779B97F4A7C15ull) >> 32);
+    }
+
+    // Readers may be probing a_table meanwhile; a slot goes from 0 to its id exactly once, so they never see
+    // anything else
+    static void InsertInto(Table& a_table, const FormID a_formid) noexcept {
+        const auto mask = a_table.capacity - 1;
+        for (auto i = Hash(a_formid) & mask;; i = (i + 1) & mask) {
+            auto& slot = a_table.slots[i];
+            const auto current = slot.load(std::memory_order_relaxed);
+            if (current == a_formid) return;
+            if (current == 0) {
+                slot.store(a_formid, std::memory_order_release);
+                a_table.count.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+    }
+
+    void PublishLocked() {
+        // a reader that finds the count at zero after the replacing table was published entered after it, and so
+        // can only have loaded that one
+        if (!_retired.empty() && _readers.load() == 0) {
+            _retired.clear();
+        }
+        if (_pending.empty()) return;
+
+        const auto table = _table.load(std::memory_order_relaxed);
+        const std::size_t needed = (table ? table->count.load(std::memory_order_relaxed) : 0) + _pending.size();
+        if (table && needed * 2 <= table->capacity) {
+            for (const auto formid : _pending) {
+                InsertInto(*table, formid);
+            }
+            _pending.clear();
+            return;
+        }
+
+        std::size_t capacity = 16;
+        while (capacity < needed * 2) capacity <<= 1;
+
+        auto new_table = std::make_unique<Table>(capacity);
+        if (table) {
+            for (std::size_t i = 0; i < table->capacity; ++i) {
+                if (const auto formid = table->slots[i].load(std::memory_order_relaxed); formid != 0) InsertInto(*new_table, formid);
+            }
+        }
+        for (const auto formid : _pending) {
+            InsertInto(*new_table, formid);
+        }
+        _pending.clear();
+
+        _table.store(new_table.get());
+        if (_current) {
+            _retired.push_back(std::move(_current));
+        }
+        _current = std::move(new_table);
+        if (_readers.load() == 0) {
+            _retired.clear();
+        }
+    }
+
+    std::atomic<Table*> _table{nullptr};
+    mutable std::atomic<std::uint32_t> _readers{0};
+    std::mutex _writeMutex;
+    std::vector<FormID> _pending;
+    std::unique_ptr<Table> _current;
+    std::vector<std::unique_ptr<Table>> _retired;  // replaced, possibly still read
+};
@@ -0,0 +1,30 @@
+#pragma once
+#include "ScratchBuffers.h"
+#include "Settings.h"
+
+// Per-container index of what each tracked reference holds, by category.
+// Kept for the player and the open container, updated from container-changed events, so a transfer looks up
+// the matching items instead of walking and classifying the whole inventory. Any change the index cannot
+// account for (or a list reload) marks it stale and it is rebuilt from the inventory on the next lookup.
+// Configuring with -DQIT_VERIFY_CONTAINER_INDEX=ON also checks the index against the inventory on every lookup.
+namespace ContainerIndex {
+    struct Candidate {
+        RE::TESBoundObject* object = nullptr;
+        std::int32_t count = 0;
+        // only filled when asked for; null for items that only exist in the base container
+        const RE::InventoryEntryData* entry = nullptr;
+    };
+
+    // The player is always tracked; other references while their container menu is open
+    void Track(RefID a_ref);
+    void Untrack(RefID a_ref);
+    // Drops every index; called before a save is loaded, since counts and objects belong to the previous session
+    void Reset();
+
+    void OnContainerChanged(RefID a_oldContainer, RefID a_newContainer, FormID a_item, std::int32_t a_count);
+
+    // Items of a_ref whose categories intersect a_typeMask (excluded forms left out), counts as GetInventory()
+    // would report them. a_withEntries also looks up each candidate's inventory entry.
+    // Returns false if a_ref is not tracked; the caller then walks the inventory itself.
+    bool Lookup(RE::TESObjectREFR* a_ref, std::uint32_t a_typeMask, bool a_withEntries, Scratch::Vector<Candidate>& a_out);
+}
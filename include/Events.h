@@ -0,0 +1,29 @@
+#pragma once
+
+// Game event sinks that keep the plugin's per-reference caches in sync
+namespace Events {
+    class EventSink final : public RE::BSTEventSink<RE::TESContainerChangedEvent>,
+                            public RE::BSTEventSink<RE::TESEquipEvent>,
+                            public RE::BSTEventSink<RE::MenuOpenCloseEvent> {
+    public:
+        static EventSink* GetSingleton() {
+            static EventSink singleton;
+            return &singleton;
+        }
+
+        RE::BSEventNotifyControl ProcessEvent(const RE::TESContainerChangedEvent* a_event,
+                                              RE::BSTEventSource<RE::TESContainerChangedEvent>*) override;
+        RE::BSEventNotifyControl ProcessEvent(const RE::TESEquipEvent* a_event,
+                                              RE::BSTEventSource<RE::TESEquipEvent>*) override;
+        RE::BSEventNotifyControl ProcessEvent(const RE::MenuOpenCloseEvent* a_event,
+                                              RE::BSTEventSource<RE::MenuOpenCloseEvent>*) override;
+
+    private:
+        EventSink() = default;
+
+        // reference whose container menu is open, 0 if none
+        RefID _menuContainer = 0;
+    };
+
+    void Install();
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+// On-disk cache of the resolved FormIDs of every category TXT file.
+// Valid only for the load order it was written with, down to each plugin's size and mtime; each file entry is
+// reused only while the source file's size and mtime are unchanged (then it is not even read) or its content hash is.
+namespace FormListCache {
+    struct SourceFile {
+        std::string path;
+        std::uint64_t size = 0;
+        std::int64_t mtime = 0;
+        std::uint64_t content_hash = 0;
+
+        bool operator==(const SourceFile&) const = default;
+    };
+
+    struct CachedFile {
+        SourceFile source;
+        std::string category;
+        std::uint32_t entry_count = 0;
+        std::vector<FormID> forms;        // listed forms, sorted, deduplicated
+        std::vector<std::string> rules;  // rule lines; their matches depend on the game data and are never cached
+    };
+
+    std::uint64_t GetLoadOrderFingerprint();
+    std::optional<SourceFile> DescribeFile(const std::filesystem::path& a_path, std::string_view a_contents);
+
+    struct Contents {
+        std::uint64_t load_order_hash = 0;
+        std::vector<CachedFile> files;
+    };
+
+    // Returns nothing if the cache is missing or corrupt. Read before the load order is known, so the caller
+    // compares load_order_hash itself.
+    std::optional<Contents> Load(const std::filesystem::path& a_cache_path);
+    void Save(const std::filesystem::path& a_cache_path, std::uint64_t a_load_order_hash, const std::vector<CachedFile>& a_files);
+}
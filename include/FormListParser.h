@@ -0,0 +1,216 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Line scanner for the category TXT files. Does not depend on the game, so offline tools can share it.
+// A file is read with a single allocation and every line is handed out as a view into that buffer.
+namespace FormListParser {
+    constexpr std::string_view kWhitespace = " \t\r\n\v\f";
+
+    // Sub-folders of the config folder, one per list; forms in "excludes" are never transferred
+    constexpr std::array<std::string_view, 6> kCategoryFolders = {"raw_food", "cooked_food", "sweets",
+                                                                  "drinks",   "building_materials", "excludes"};
+    constexpr std::string_view kExcludesFolder = "excludes";
+
+    constexpr std::string_view Trim(std::string_view a_str) {
+        const auto start = a_str.find_first_not_of(kWhitespace);
+        if (start == std::string_view::npos) {
+            return {};
+        }
+        const auto end = a_str.find_last_not_of(kWhitespace);
+        return a_str.substr(start, end - start + 1);
+    }
+
+    // FNV-1a; used to fingerprint file contents and load orders for the form list cache
+    constexpr std::uint64_t HashBytes(const std::string_view a_bytes, std::uint64_t a_hash = 0xcbf29ce484222325ull) {
+        for (const auto ch : a_bytes) {
+            a_hash ^= static_cast<unsigned char>(ch);
+            a_hash *= 0x100000001b3ull;
+        }
+        return a_hash;
+    }
+
+    constexpr bool IsComment(const std::string_view a_trimmed) {
+        return a_trimmed.empty() || a_trimmed.front() == '#' || a_trimmed.front() == ';';
+    }
+
+    // Reads the whole file into a_buffer (reusing its capacity). Returns false if it cannot be opened.
+    inline bool ReadFile(const std::filesystem::path& a_path, std::string& a_buffer) {
+        std::ifstream file(a_path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            return false;
+        }
+        const auto size = static_cast<std::size_t>(file.tellg());
+        a_buffer.resize(size);
+        file.seekg(0);
+        return size == 0 || file.read(a_buffer.data(), static_cast<std::streamsize>(size)).good();
+    }
+
+    // Calls a_func(std::string_view entry, std::uint32_t line_number) for every non-comment line.
+    // Line breaks are located with memchr, which the CRT vectorizes.
+    template <typename Func>
+    void ForEachEntry(std::string_view a_buffer, Func&& a_func) {
+        if (a_buffer.starts_with("\xEF\xBB\xBF")) {
+            a_buffer.remove_prefix(3);
+        }
+
+        const char* cursor = a_buffer.data();
+        const char* const end = cursor + a_buffer.size();
+        std::uint32_t line_number = 0;
+        while (cursor < end) {
+            ++line_number;
+            const auto newline = static_cast<const char*>(std::memchr(cursor, '\n', static_cast<std::size_t>(end - cursor)));
+            const char* const line_end = newline ? newline : end;
+
+            if (const auto entry = Trim({cursor, static_cast<std::size_t>(line_end - cursor)}); !IsComment(entry)) {
+                a_func(entry, line_number);
+            }
+            if (!newline) {
+                break;
+            }
+            cursor = newline + 1;
+        }
+    }
+
+    // What a single entry names, before anything is looked up in the game
+    struct Token {
+        enum class Kind : std::uint8_t {
+            kEditorID,     // BearPelt
+            kPluginLocal,  // 0x12345~MyMod.esp
+            kFormID,       // 0x000DB5D2
+            kRule,         // rule: type=Misc weight<0.5
+            kUnknown       // left to the game-side reader
+        };
+
+        Kind kind = Kind::kUnknown;
+        std::uint32_t id = 0;         // local id for kPluginLocal, full id for kFormID
+        std::string_view name;        // plugin file name, editor id or rule conditions
+    };
+
+    // "rule:" lines describe a category by properties instead of listing its forms.
+    // Conditions are separated by whitespace and must all hold; '!' in front of one negates it:
+    //   rule: type=Misc keyword=VendorItemClutter weight<0.5 value>100 !keyword=VendorItemGem
+    constexpr std::string_view kRulePrefix = "rule:";
+
+    struct RuleCondition {
+        enum class Field : std::uint8_t { kType, kKeyword, kWeight, kValue };
+        enum class Compare : std::uint8_t { kEqual, kLess, kLessEqual, kGreater, kGreaterEqual };
+
+        Field field = Field::kType;
+        Compare compare = Compare::kEqual;
+        bool negate = false;
+        std::string_view text;  // type name or keyword for kType / kKeyword
+        float number = 0.f;     // bound for kWeight / kValue
+    };
+
+    constexpr bool ParseHex(std::string_view a_str, std::uint32_t& a_value) {
+        if (a_str.starts_with("0x") || a_str.starts_with("0X")) {
+            a_str.remove_prefix(2);
+        }
+        if (a_str.empty() || a_str.size() > 8) {
+            return false;
+        }
+        const auto [ptr, ec] = std::from_chars(a_str.data(), a_str.data() + a_str.size(), a_value, 16);
+        return ec == std::errc{} && ptr == a_str.data() + a_str.size();
+    }
+
+    constexpr Token ParseToken(const std::string_view a_entry) {
+        Token token;
+        if (a_entry.starts_with(kRulePrefix)) {
+            token.kind = Token::Kind::kRule;
+            token.name = Trim(a_entry.substr(kRulePrefix.size()));
+            return token;
+        }
+        if (const auto tilde = a_entry.find('~'); tilde != std::string_view::npos) {
+            const auto plugin = Trim(a_entry.substr(tilde + 1));
+            if (!plugin.empty() && ParseHex(Trim(a_entry.substr(0, tilde)), token.id)) {
+                token.kind = Token::Kind::kPluginLocal;
+                token.name = plugin;
+            }
+            return token;
+        }
+        if (a_entry.starts_with("0x") || a_entry.starts_with("0X")) {
+            if (ParseHex(a_entry, token.id)) {
+                token.kind = Token::Kind::kFormID;
+            }
+            return token;
+        }
+        if (!a_entry.empty() && a_entry.find_first_of(kWhitespace) == std::string_view::npos) {
+            token.kind = Token::Kind::kEditorID;
+            token.name = a_entry;
+        }
+        return token;
+    }
+
+    // Splits the conditions of a rule (the part after "rule:"). On failure a_error names the problem.
+    inline bool ParseRule(std::string_view a_conditions, std::vector<RuleCondition>& a_out, std::string_view& a_error) {
+        a_out.clear();
+        while (!(a_conditions = Trim(a_conditions)).empty()) {
+            const auto end = std::min(a_conditions.find_first_of(kWhitespace), a_conditions.size());
+            auto text = a_conditions.substr(0, end);
+            a_conditions.remove_prefix(end);
+
+            RuleCondition condition;
+            if (text.starts_with('!')) {
+                condition.negate = true;
+                text.remove_prefix(1);
+            }
+
+            const auto op_start = text.find_first_of("<>=");
+            if (op_start == std::string_view::npos || op_start == 0) {
+                a_error = "expected <field><comparison><value>";
+                return false;
+            }
+            const auto field = text.substr(0, op_start);
+            const auto op_end = text.find_first_not_of("<>=", op_start);
+            const auto op = text.substr(op_start, op_end == std::string_view::npos ? std::string_view::npos : op_end - op_start);
+            const auto value = op_end == std::string_view::npos ? std::string_view{} : text.substr(op_end);
+            if (value.empty()) {
+                a_error = "missing value";
+                return false;
+            }
+
+            if (op == "=") condition.compare = RuleCondition::Compare::kEqual;
+            else if (op == "<") condition.compare = RuleCondition::Compare::kLess;
+            else if (op == "<=") condition.compare = RuleCondition::Compare::kLessEqual;
+            else if (op == ">") condition.compare = RuleCondition::Compare::kGreater;
+            else if (op == ">=") condition.compare = RuleCondition::Compare::kGreaterEqual;
+            else {
+                a_error = "unknown comparison";
+                return false;
+            }
+
+            if (field == "type" || field == "keyword") {
+                if (condition.compare != RuleCondition::Compare::kEqual) {
+                    a_error = "type and keyword only support '='";
+                    return false;
+                }
+                condition.field = field == "type" ? RuleCondition::Field::kType : RuleCondition::Field::kKeyword;
+                condition.text = value;
+            } else if (field == "weight" || field == "value") {
+                condition.field = field == "weight" ? RuleCondition::Field::kWeight : RuleCondition::Field::kValue;
+                const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), condition.number);
+                if (ec != std::errc{} || ptr != value.data() + value.size()) {
+                    a_error = "expected a number";
+                    return false;
+                }
+            } else {
+                a_error = "unknown field (type, keyword, weight, value)";
+                return false;
+            }
+            a_out.push_back(condition);
+        }
+        if (a_out.empty()) {
+            a_error = "rule has no conditions";
+            return false;
+        }
+        return true;
+    }
+}
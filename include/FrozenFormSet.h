@@ -0,0 +1,140 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <vector>
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    #include <emmintrin.h>
+    #define QIT_FROZEN_FORM_SET_SSE2
+#endif
+
+// Read-only FormID set stored as one table of 16-id buckets, each a single cache line.
+// An id hashes to a bucket and is compared against all 16 slots at once; a bucket that filled up spills into the
+// next one, and a lookup stops at the first bucket with a free slot. Lookups so touch one cache line in the common
+// case with no pointer to chase, where a node-based set reads the bucket array and then the node. Built once per
+// snapshot and never modified; buckets are filled to 3/4 on average, about 5.3 bytes per id and no per-entry node.
+// 0 is no form and marks a free slot, so it is never a member.
+class FrozenFormSet {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = FormID;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const FormID*;
+        using reference = const FormID&;
+
+        Iterator() = default;
+        Iterator(const FormID* a_slot, const FormID* a_end) noexcept : _slot(a_slot), _end(a_end) { SkipFree(); }
+
+        reference operator*() const noexcept { return *_slot; }
+        Iterator& operator++() noexcept {
+            ++_slot;
+            SkipFree();
+            return *this;
+        }
+        Iterator operator++(int) noexcept {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+        bool operator==(const Iterator& a_other) const noexcept { return _slot == a_other._slot; }
+
+    private:
+        void SkipFree() noexcept {
+            while (_slot != _end && *_slot == FREE) ++_slot;
+        }
+
+        const FormID* _slot = nullptr;
+        const FormID* _end = nullptr;
+    };
+
+    FrozenFormSet() = default;
+
+    explicit FrozenFormSet(const std::vector<FormID>& a_forms) {
+        _buckets = a_forms.size() / FILL + 1;
+        _slots.assign(_buckets * BUCKET, FREE);
+        for (const auto formid : a_forms) {
+            if (formid == FREE) continue;
+            for (auto bucket = Home(formid);; bucket = Next(bucket)) {
+                auto* const slots = _slots.data() + bucket * BUCKET;
+                const auto free = Match(slots, FREE);
+                if (Match(slots, formid)) break;
+                if (free) {
+                    slots[std::countr_zero(free)] = formid;
+                    ++_size;
+                    break;
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] bool contains(const FormID a_formid) const noexcept {
+        if (_size == 0 || a_formid == FREE) return false;
+        for (auto bucket = Home(a_formid);; bucket = Next(bucket)) {
+            const auto* const slots = _slots.data() + bucket * BUCKET;
+            if (Match(slots, a_formid)) return true;
+            if (Match(slots, FREE)) return false;
+        }
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return _size; }
+    [[nodiscard]] bool empty() const noexcept { return _size == 0; }
+    [[nodiscard]] std::size_t memory_usage() const noexcept { return _slots.capacity() * sizeof(FormID); }
+
+    // Members in no particular order
+    [[nodiscard]] Iterator begin() const noexcept { return {_slots.data(), _slots.data() + _slots.size()}; }
+    [[nodiscard]] Iterator end() const noexcept { return {_slots.data() + _slots.size(), _slots.data() + _slots.size()}; }
+
+private:
+    // slots per bucket; one 64-byte cache line
+    static constexpr std::size_t BUCKET = 16;
+    // ids per bucket on average; leaves room so few buckets spill
+    static constexpr std::size_t FILL = 12;
+    static constexpr FormID FREE = 0;
+
+    // Buckets must not straddle cache lines
+    template <typename T>
+    struct CacheLineAllocator {
+        using value_type = T;
+        static constexpr std::align_val_t ALIGNMENT{64};
+
+        CacheLineAllocator() noexcept = default;
+        template <typename U>
+        CacheLineAllocator(const CacheLineAllocator<U>&) noexcept {}
+
+        [[nodiscard]] T* allocate(const std::size_t a_count) { return static_cast<T*>(::operator new(a_count * sizeof(T), ALIGNMENT)); }
+        void deallocate(T* a_ptr, std::size_t) noexcept { ::operator delete(a_ptr, ALIGNMENT); }
+
+        template <typename U>
+        bool operator==(const CacheLineAllocator<U>&) const noexcept { return true; }
+    };
+
+    // Ids from one plugin are dense in the low bits; the multiply spreads them over the high bits, which pick the
+    // bucket without a division
+    [[nodiscard]] std::size_t Home(const FormID a_formid) const noexcept {
+        return static_cast<std::size_t>((static_cast<std::uint64_t>(a_formid * 0x9E3779B1u) * _buckets) >> 32);
+    }
+    [[nodiscard]] std::size_t Next(const std::size_t a_bucket) const noexcept { return a_bucket + 1 == _buckets ? 0 : a_bucket + 1; }
+
+    // Bit i set if slot i of a_slots holds a_formid
+    static std::uint32_t Match(const FormID* a_slots, const FormID a_formid) noexcept {
+#ifdef QIT_FROZEN_FORM_SET_SSE2
+        const auto id = _mm_set1_epi32(static_cast<int>(a_formid));
+        const auto slots = reinterpret_cast<const __m128i*>(a_slots);
+        const auto low = _mm_packs_epi32(_mm_cmpeq_epi32(id, _mm_load_si128(slots)), _mm_cmpeq_epi32(id, _mm_load_si128(slots + 1)));
+        const auto high = _mm_packs_epi32(_mm_cmpeq_epi32(id, _mm_load_si128(slots + 2)), _mm_cmpeq_epi32(id, _mm_load_si128(slots + 3)));
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_packs_epi16(low, high)));
+#else
+        std::uint32_t mask = 0;
+        for (std::size_t i = 0; i < BUCKET; ++i) mask |= static_cast<std::uint32_t>(a_slots[i] == a_formid) << i;
+        return mask;
+#endif
+    }
+
+    std::vector<FormID, CacheLineAllocator<FormID>> _slots;
+    std::size_t _buckets = 0;
+    std::size_t _size = 0;
+};
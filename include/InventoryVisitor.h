@@ -0,0 +1,66 @@
+#pragma once
+#include "ScratchBuffers.h"
+
+// Streaming walk over a reference's inventory without building the GetInventory() map.
+// Counts are merged the same way GetInventory() does it: inventory change entries first (their delta plus the
+// base container count unless the entry is leveled), then base container objects that have no change entry.
+namespace Inventory {
+    // a_filter(TESBoundObject*) -> bool runs first and decides whether an item is looked at at all.
+    // a_visitor(TESBoundObject*, std::int32_t count, const InventoryEntryData* entry) -> bool, false stops the walk.
+    // entry is null for items that only exist in the base container and points into the live inventory otherwise,
+    // so it must not be kept past the walk. Returns the number of entries looked at, matching or not.
+    template <typename Filter, typename Visitor>
+    std::size_t ForEachItem(RE::TESObjectREFR* a_ref, Filter&& a_filter, Visitor&& a_visitor) {
+        std::size_t scanned = 0;
+        const auto container = a_ref->GetContainer();
+
+        // only matching items end up here; kept per thread so repeated walks reuse it (a walk must not start
+        // another one with the same filter and visitor types from inside a_visitor)
+        thread_local Scratch::Vector<const RE::TESBoundObject*> visited;
+        visited.clear();
+
+        if (const auto changes = a_ref->GetInventoryChanges(); changes && changes->entryList) {
+            for (const auto entry : *changes->entryList) {
+                ++scanned;
+                const auto item = entry ? entry->object : nullptr;
+                if (!item || !a_filter(item)) {
+                    continue;
+                }
+                visited.push_back(item);
+
+                auto count = entry->countDelta;
+                if (container && !entry->IsLeveled()) {
+                    count += container->CountObjectsInContainer(item);
+                }
+                if (count > 0 && !a_visitor(item, count, entry)) {
+                    return scanned;
+                }
+            }
+        }
+
+        if (container) {
+            // kept sorted from here on, so each base container object is a binary search instead of a scan
+            std::ranges::sort(visited);
+            container->ForEachContainerObject([&](RE::ContainerObject& a_object) {
+                ++scanned;
+                const auto item = a_object.obj;
+                if (!item || !a_filter(item)) {
+                    return RE::BSContainer::ForEachResult::kContinue;
+                }
+                const auto pos = std::ranges::lower_bound(visited, item);
+                if (pos != visited.end() && *pos == item) {
+                    return RE::BSContainer::ForEachResult::kContinue;
+                }
+                // an object listed several times in the base container is merged into one visit
+                visited.insert(pos, item);
+
+                const auto count = container->CountObjectsInContainer(item);
+                if (count > 0 && !a_visitor(item, count, static_cast<const RE::InventoryEntryData*>(nullptr))) {
+                    return RE::BSContainer::ForEachResult::kStop;
+                }
+                return RE::BSContainer::ForEachResult::kContinue;
+            });
+        }
+        return scanned;
+    }
+}
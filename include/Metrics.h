@@ -0,0 +1,83 @@
+#pragma once
+#include "Settings.h"
+
+// Always-on timing of transfers and form list loading.
+// Recording is a few relaxed atomic increments; percentiles and reports are only computed when read.
+namespace Metrics {
+    using Clock = std::chrono::steady_clock;
+
+    // Log-linear histogram of durations in microseconds (4 buckets per power of two, up to ~2^31 us)
+    class LatencyHistogram {
+    public:
+        void Record(Clock::duration a_duration) noexcept;
+
+        [[nodiscard]] std::uint64_t Count() const noexcept { return _count.load(std::memory_order_relaxed); }
+        // a_percentile in [0, 100]; returns microseconds, 0 if nothing was recorded
+        [[nodiscard]] double Percentile(double a_percentile) const noexcept;
+
+    private:
+        static constexpr std::size_t kSubBuckets = 4;
+        static constexpr std::size_t kBuckets = 32 * kSubBuckets;
+
+        static std::size_t BucketOf(std::uint64_t a_micros) noexcept;
+        static double BucketUpperBound(std::size_t a_bucket) noexcept;
+
+        std::array<std::atomic<std::uint64_t>, kBuckets> _buckets{};
+        std::atomic<std::uint64_t> _count{0};
+    };
+
+    // Work and queue waits of one transfer, in the order they happen. kFilter covers setup and collecting the matching
+    // inventory entries, which happen in one walk. kApply adds up the item moves of every frame the transfer is spread
+    // over, and kApplyWait is the rest of the time from the commit to the last move: frames in between and batches
+    // queued ahead. kUIEnqueue is spent queueing game tasks: the commit task and the menu refreshes.
+    enum class TransferPhase : std::uint8_t { kFilter, kPlanWait, kPlan, kUIEnqueue, kCommitWait, kApply, kApplyWait, kTotal };
+    inline constexpr std::size_t kTransferPhaseCount = static_cast<std::size_t>(TransferPhase::kTotal) + 1;
+
+    // Per-ItemTypes slots; kNone collects multi-category transfers
+    inline constexpr std::size_t kTransferSlotCount = static_cast<std::size_t>(kNone) + 1;
+
+    // Collects the phase timings of one transfer and records them on Finish(). Travels with the transfer from the
+    // inventory pass through planning and commit to the last applied item.
+    class TransferTimer {
+    public:
+        explicit TransferTimer(std::size_t a_slot) noexcept : _slot(a_slot), _start(Clock::now()), _last(_start) {}
+
+        // Adds the time since the previous EndPhase (or the start) to a_phase
+        void EndPhase(TransferPhase a_phase) noexcept;
+        // Adds work done in pieces (apply slices) to a_phase, leaving the EndPhase boundary where it is
+        void AddTime(TransferPhase a_phase, Clock::duration a_duration) noexcept;
+        void SetCounts(std::size_t a_scanned, std::size_t a_moved) noexcept;
+        // kApplyWait gets the part of the total that no other phase accounts for
+        void Finish() noexcept;
+
+    private:
+        std::size_t _slot;
+        Clock::time_point _start;
+        Clock::time_point _last;
+        std::array<Clock::duration, kTransferPhaseCount> _phases{};
+        std::size_t _scanned = 0;
+        std::size_t _moved = 0;
+    };
+
+    // What became of a Papyrus transfer request
+    enum class RequestOutcome : std::uint8_t { kRun, kMerged, kDropped };
+    void RecordTransferRequest(RequestOutcome a_outcome) noexcept;
+
+    // Marks the calling thread as working on a transfer while it lives; scopes may nest. Debug builds count every
+    // heap allocation the plugin makes on a marked thread, for the performance report; release builds do nothing.
+    class TransferScope {
+    public:
+        TransferScope() noexcept;
+        ~TransferScope();
+        TransferScope(const TransferScope&) = delete;
+        TransferScope& operator=(const TransferScope&) = delete;
+    };
+
+    void RecordFileLoad(std::string_view a_path, std::string_view a_category, Clock::duration a_parse,
+                        Clock::duration a_resolve, std::size_t a_entries, std::size_t a_forms, bool a_cached);
+
+    // Latency of whole transfers for one slot, in milliseconds
+    double GetTransferPercentile(std::size_t a_slot, double a_percentile);
+
+    std::string BuildReport();
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+// Per-actor counts of inventory copies that belong to the actor's default outfit.
+// Filled lazily per item the first time a transfer needs it; an entry is recounted after the
+// item changes container or is (un)equipped on that actor.
+namespace OutfitCache {
+    std::int32_t GetOutfitCount(RefID a_actor, FormID a_outfit, const RE::TESBoundObject* a_item,
+                                const RE::InventoryEntryData* a_entry);
+
+    void Invalidate(RefID a_actor, FormID a_item);
+    // Forgets every actor; called before a save is loaded
+    void Clear();
+}
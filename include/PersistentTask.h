@@ -0,0 +1,37 @@
+#pragma once
+
+// Game and UI tasks for functions the transfer path schedules over and over.
+// AddTask/AddUITask with a std::function heap-allocate a task wrapper on every call. These hand SKSE one object per
+// function instead, which lives for the whole session and ignores Dispose, so queueing it allocates nothing in the
+// plugin. The same object may be queued several times; each time runs the function once.
+namespace PersistentTask {
+    namespace detail {
+        template <void (*Function)()>
+        class Task final : public SKSE::TaskDelegate {
+        public:
+            void Run() override { Function(); }
+            void Dispose() override {}
+        };
+
+        template <void (*Function)()>
+        class UITask final : public SKSE::UIDelegate_v1 {
+        public:
+            void Run() override { Function(); }
+            void Dispose() override {}
+        };
+    }
+
+    // Runs Function on the main thread
+    template <void (*Function)()>
+    void Add() {
+        static detail::Task<Function> task;
+        SKSE::GetTaskInterface()->AddTask(&task);
+    }
+
+    // Runs Function on the UI thread
+    template <void (*Function)()>
+    void AddUI() {
+        static detail::UITask<Function> task;
+        SKSE::GetTaskInterface()->AddUITask(&task);
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "FormListParser.h"
+
+// Category rules from the TXT files, compiled into one flat instruction list.
+// The rules are evaluated over every loaded inventory object on each game start and after a rule is edited, and the
+// matches are merged into the lists, so a rule costs nothing when items are transferred. The matches are never
+// written to the form list cache.
+class RuleProgram {
+public:
+    // Compiles one rule; matches are reported under a_tag. Returns false and fills a_error if a type or keyword is unknown.
+    bool AddRule(std::span<const FormListParser::RuleCondition> a_conditions, std::size_t a_tag, std::string& a_error);
+
+    [[nodiscard]] bool empty() const noexcept { return _rules.empty(); }
+    [[nodiscard]] std::size_t size() const noexcept { return _rules.size(); }
+
+    // Runs every rule over every inventory object on the task pool; result[tag] holds the matching FormIDs.
+    // Main thread only: the pool reads the forms while the caller waits.
+    [[nodiscard]] std::vector<std::vector<FormID>> Run(std::size_t a_tagCount) const;
+
+private:
+    enum class Opcode : std::uint8_t { kType, kKeyword, kWeightLess, kWeightGreater, kWeightEqual, kValueLess, kValueGreater, kValueEqual };
+
+    struct Instruction {
+        Opcode opcode;
+        bool negate;
+        RE::FormType type;
+        const RE::BGSKeyword* keyword;
+        float bound;
+    };
+
+    struct Rule {
+        std::uint32_t first;
+        std::uint32_t count;
+        std::size_t tag;
+    };
+
+    [[nodiscard]] bool Matches(const Rule& a_rule, RE::TESBoundObject* a_object) const;
+
+    std::vector<Instruction> _code;
+    std::vector<Rule> _rules;
+};
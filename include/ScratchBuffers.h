@@ -0,0 +1,60 @@
+#pragma once
+
+// Reusable buffers for the transfer path.
+// A transfer's buffers travel with it from the main thread to the planning worker and the queue, and are handed
+// back to a pool once it is done. Released buffers keep their capacity, so after the first few transfers have
+// grown them to the usual size, further transfers draw all of their scratch memory from the pools.
+namespace Scratch {
+    // A plain vector; what makes it scratch is coming from and going back to a pool. Debug builds count the
+    // allocations these still make along with everything else on the transfer path (Metrics::TransferScope).
+    template <typename T>
+    using Vector = std::vector<T>;
+
+    // Free list of buffers of one element type, shared by all threads
+    template <typename T>
+    class Pool {
+    public:
+        static Pool& GetSingleton() {
+            static Pool pool;
+            return pool;
+        }
+
+        // An empty buffer, with the capacity of an earlier one if any was released. With nothing released (the first
+        // transfers, or more than kMaxFree in flight at once) it has no capacity and allocates as it grows.
+        [[nodiscard]] Vector<T> Acquire() {
+            std::lock_guard lock(_mutex);
+            if (_free.empty()) return {};
+            auto buffer = std::move(_free.back());
+            _free.pop_back();
+            return buffer;
+        }
+
+        void Release(Vector<T>&& a_buffer) {
+            if (a_buffer.capacity() == 0) return;
+            a_buffer.clear();
+            std::lock_guard lock(_mutex);
+            // anything past the cap is freed; that many transfers in flight at once is not the steady state
+            if (_free.size() < kMaxFree) {
+                _free.push_back(std::move(a_buffer));
+            }
+        }
+
+    private:
+        static constexpr std::size_t kMaxFree = 16;
+
+        Pool() { _free.reserve(kMaxFree); }
+
+        std::mutex _mutex;
+        std::vector<Vector<T>> _free;
+    };
+
+    template <typename T>
+    [[nodiscard]] Vector<T> Acquire() {
+        return Pool<T>::GetSingleton().Acquire();
+    }
+
+    template <typename T>
+    void Release(Vector<T>&& a_buffer) {
+        Pool<T>::GetSingleton().Release(std::move(a_buffer));
+    }
+}
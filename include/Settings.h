@@ -1,10 +1,57 @@
 #pragma once
+#include "ConcurrentFormSet.h"
+#include "FrozenFormSet.h"
+#include <memory>
+#include <unordered_map>
 #include <unordered_set>
 
+enum ItemTypes {
+    kWeapon,
+    kAmmo,
+    kArmorStrict,
+    kJewelry,
+    kShield,
+    kClothing,
+    kPoison,
+    kPotion,
+    kScrollItem,
+    kFood,
+    kRawFood,
+    kCookedFood,
+    kSweets,
+    kDrinks,
+    kIngredient,
+    kBookAll,
+    kBookSpell,
+    kBookSkill,
+    kBookRecipe,
+    kBookStrict,
+    kKey,
+    kMiscAll,
+    kSoulGem,
+    kOres,
+    kGems,
+    kLeatherNPelts,
+    kBuildingMaterials,
+    kNone
+};
+
+inline bool IsItemType(const ItemTypes a_itemtype) {
+    return a_itemtype < kNone;
+}
+
+constexpr std::uint32_t ItemTypeBit(const ItemTypes a_itemtype) {
+    return 1u << static_cast<std::uint32_t>(a_itemtype);
+}
+
 namespace Settings {
     constexpr std::string_view esp_name = "Quick Item Transfer.esp";
     constexpr RE::FormID exclude_weightless_localID = 0x802;
     inline RE::TESGlobal* exclude_weightless_global = nullptr;
+    // Capacity-limited transfers pick the most valuable items per weight instead of going in inventory order
+    inline std::atomic<bool> value_density_selection{false};
+    // Poll the category folders while the game runs and reload edited TXT files (off unless a script turns it on)
+    inline std::atomic<bool> watch_form_lists{false};
     void LoadSettings();
 }
 
@@ -13,36 +60,75 @@ namespace FormLists {
     // Gem, Ore/Ingot, Animal Hide, Raw Food, Jewelry, Recipe
     inline std::array<RE::BGSKeyword*, 6> vendorItemKeywords = {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr};
 
-    inline std::unordered_set<FormID> all_raw_food;
-    inline std::unordered_set<FormID> all_cooked_food;
-    inline std::unordered_set<FormID> all_sweets;
-    inline std::unordered_set<FormID> all_drinks;
-    inline std::unordered_set<FormID> all_building_materials;
+    // Contents of the category TXT folders and the category index derived from them.
+    // Immutable once published: a reload builds a new snapshot and swaps it in, so a transfer that
+    // grabbed the previous one keeps a consistent view until it finishes.
+    struct Snapshot {
+        FrozenFormSet raw_food;
+        FrozenFormSet cooked_food;
+        FrozenFormSet sweets;
+        FrozenFormSet drinks;
+        FrozenFormSet building_materials;
+        FrozenFormSet excluded_forms;
 
-    // doesnt have folder, loaded on demand
-    inline std::unordered_set<FormID> all_ingot_ores;
-    inline std::unordered_set<FormID> all_gems;
-    inline std::unordered_set<FormID> all_leather_n_pelts;
-    inline std::unordered_set<FormID> all_jewelry;
-    inline std::unordered_set<FormID> all_recipes;
+        // FormID -> one bit per ItemTypes value.
+        // Excluded forms carry kExcludedBit so the transfer loop needs a single probe.
+        std::unordered_map<FormID, std::uint32_t> category_index;
+    };
+
+    constexpr std::uint32_t kExcludedBit = 1u << 31;
+    static_assert(kNone < 31, "ItemTypes does not fit in the category bitmask");
+
+    // Never null; empty until the first snapshot is published at kDataLoaded
+    std::shared_ptr<const Snapshot> GetSnapshot();
+    void PublishSnapshot(std::shared_ptr<const Snapshot> a_snapshot);
 
-    inline std::unordered_set<FormID> excluded_forms;
+    // doesnt have folder, loaded on demand. Filled from any thread, so lookups go through a published table.
+    inline ConcurrentFormSet all_ingot_ores;
+    inline ConcurrentFormSet all_gems;
+    inline ConcurrentFormSet all_leather_n_pelts;
+    inline ConcurrentFormSet all_jewelry;
+    inline ConcurrentFormSet all_recipes;
+    inline ConcurrentFormSet raw_food_by_kw;
 
-    // Main entry point: loads all form lists from TXT files (multithreaded)
+    // Starts the filesystem scan and text parsing on a background thread; needs no game data
+    void StartLoadingFormLists();
+    // Main entry point at kDataLoaded: joins the background parse and resolves the FormIDs (multithreaded)
     void GetAllFormLists();
+    // Re-reads changed TXT files and publishes a new snapshot if anything changed; when rules changed, the main thread
+    // evaluates them and publishes on its next task run. a_force re-parses every file. Returns true if anything changed.
+    bool ReloadFormLists(bool a_force);
+    // Polls the category folders in a background thread and reloads changed files while Settings::watch_form_lists
+    // is set; the thread ends once it is cleared
+    void StartWatchingFormLists();
     void LoadKeywords();
+    // Every loaded bound object of a form type that can end up in an inventory
+    std::vector<RE::TESBoundObject*> GetInventoryObjects();
+    // Classifies every loaded form by type and keyword, i.e. everything that does not come from the TXT lists
+    void BuildCategoryIndex();
+    // Fills a_snapshot.category_index from the base index and the snapshot's own lists
+    void BuildSnapshotIndex(Snapshot& a_snapshot);
 
-    inline bool IsCookedFood(const FormID a_formid) { return all_cooked_food.contains(a_formid); }
-    inline bool IsSweets(const FormID a_formid) { return all_sweets.contains(a_formid); }
-    inline bool IsDrinks(const FormID a_formid) { return all_drinks.contains(a_formid); }
-    inline bool IsBuildingMaterials(const FormID a_formid) { return all_building_materials.contains(a_formid); }
+    // Computes the bitmask from scratch. Used while building the index and for forms created at runtime.
+    std::uint32_t ClassifyItem(RE::TESBoundObject* a_item, const Snapshot& a_lists);
+    std::uint32_t GetCategoryMask(RE::TESBoundObject* a_item, const Snapshot& a_lists);
+
+    inline bool IsCookedFood(const FormID a_formid, const Snapshot& a_lists) { return a_lists.cooked_food.contains(a_formid); }
+    inline bool IsSweets(const FormID a_formid, const Snapshot& a_lists) { return a_lists.sweets.contains(a_formid); }
+    inline bool IsDrinks(const FormID a_formid, const Snapshot& a_lists) { return a_lists.drinks.contains(a_formid); }
+    inline bool IsBuildingMaterials(const FormID a_formid, const Snapshot& a_lists) {
+        return a_lists.building_materials.contains(a_formid);
+    }
 
     // doesnt have folder, loaded on demand
-    bool IsByKW(const RE::TESBoundObject* a_item, std::unordered_set<FormID>& a_cache, int a_kw_index);
+    bool IsByKW(const RE::TESBoundObject* a_item, ConcurrentFormSet& a_cache, int a_kw_index);
+    void PublishKeywordCaches();
     inline bool IsGems(const RE::TESBoundObject* a_item) { return IsByKW(a_item, all_gems, 0); }
     inline bool IsIngotsOres(const RE::TESBoundObject* a_item) { return IsByKW(a_item, all_ingot_ores, 1); }
     inline bool IsLeatherNPelts(const RE::TESBoundObject* a_item) { return IsByKW(a_item, all_leather_n_pelts, 2); }
-    inline bool IsRawFood(const RE::TESBoundObject* a_item) { return IsByKW(a_item, all_raw_food, 3); }
+    inline bool IsRawFood(const RE::TESBoundObject* a_item, const Snapshot& a_lists) {
+        return a_lists.raw_food.contains(a_item->GetFormID()) || IsByKW(a_item, raw_food_by_kw, 3);
+    }
     inline bool IsJewelry(const RE::TESBoundObject* a_item) { return IsByKW(a_item, all_jewelry, 4); }
     inline bool IsRecipe(const RE::TESBoundObject* a_item) { return IsByKW(a_item, all_recipes, 5); }
 
@@ -56,110 +142,73 @@ namespace FormLists {
     bool IsBookStrict(RE::TESBoundObject* a_item);
 }
 
-enum ItemTypes {
-    kWeapon,
-    kAmmo,
-    kArmorStrict,
-    kJewelry,
-    kShield,
-    kClothing,
-    kPoison,
-    kPotion,
-    kScrollItem,
-    kFood,
-    kRawFood,
-    kCookedFood,
-    kSweets,
-    kDrinks,
-    kIngredient,
-    kBookAll,
-    kBookSpell,
-    kBookSkill,
-    kBookRecipe,
-    kBookStrict,
-    kKey,
-    kMiscAll,
-    kSoulGem,
-    kOres,
-    kGems,
-    kLeatherNPelts,
-    kBuildingMaterials,
-    kNone
-};
-
-inline bool IsItemType(const ItemTypes a_itemtype) {
-    return a_itemtype < kNone;
+// Per-category predicate, resolved at compile time so callers get a fully inlined check.
+// a_lists supplies the TXT-backed categories.
+template <ItemTypes T>
+bool IsOfItemType(RE::TESBoundObject* a_obj, [[maybe_unused]] const FormLists::Snapshot& a_lists) {
+    if constexpr (T == kWeapon) {
+        return a_obj->Is(RE::FormType::Weapon);
+    } else if constexpr (T == kAmmo) {
+        return a_obj->Is(RE::FormType::Ammo);
+    } else if constexpr (T == kArmorStrict) {
+        return FormLists::IsArmorStrict(a_obj);
+    } else if constexpr (T == kJewelry) {
+        return FormLists::IsJewelry(a_obj);
+    } else if constexpr (T == kShield) {
+        return FormLists::IsShield(a_obj);
+    } else if constexpr (T == kClothing) {
+        return FormLists::IsClothing(a_obj);
+    } else if constexpr (T == kPoison) {
+        const auto temp = a_obj->As<RE::AlchemyItem>();
+        return temp && !temp->IsFood() && temp->IsPoison();
+    } else if constexpr (T == kPotion) {
+        const auto temp = a_obj->As<RE::AlchemyItem>();
+        return temp && !temp->IsFood() && !temp->IsPoison();
+    } else if constexpr (T == kScrollItem) {
+        return a_obj->Is(RE::FormType::Scroll);
+    } else if constexpr (T == kFood) {
+        const auto alch_item = a_obj->As<RE::AlchemyItem>();
+        return alch_item && alch_item->IsFood();
+    } else if constexpr (T == kRawFood) {
+        return FormLists::IsRawFood(a_obj, a_lists);
+    } else if constexpr (T == kCookedFood) {
+        return FormLists::IsCookedFood(a_obj->GetFormID(), a_lists);
+    } else if constexpr (T == kSweets) {
+        return FormLists::IsSweets(a_obj->GetFormID(), a_lists);
+    } else if constexpr (T == kDrinks) {
+        return FormLists::IsDrinks(a_obj->GetFormID(), a_lists);
+    } else if constexpr (T == kIngredient) {
+        return a_obj->Is(RE::FormType::Ingredient);
+    } else if constexpr (T == kBookAll) {
+        return a_obj->Is(RE::FormType::Book);
+    } else if constexpr (T == kBookSkill) {
+        return FormLists::IsBookSkill(a_obj);
+    } else if constexpr (T == kBookSpell) {
+        return FormLists::IsBookSpell(a_obj);
+    } else if constexpr (T == kBookRecipe) {
+        return FormLists::IsRecipe(a_obj);
+    } else if constexpr (T == kBookStrict) {
+        return FormLists::IsBookStrict(a_obj);
+    } else if constexpr (T == kKey) {
+        return a_obj->Is(RE::FormType::KeyMaster);
+    } else if constexpr (T == kMiscAll) {
+        return a_obj->Is(RE::FormType::Misc) || a_obj->IsSoulGem() || a_obj->Is(RE::FormType::Light);
+    } else if constexpr (T == kSoulGem) {
+        return a_obj->Is(RE::FormType::SoulGem);
+    } else if constexpr (T == kOres) {
+        return FormLists::IsIngotsOres(a_obj);
+    } else if constexpr (T == kGems) {
+        return FormLists::IsGems(a_obj);
+    } else if constexpr (T == kLeatherNPelts) {
+        return FormLists::IsLeatherNPelts(a_obj);
+    } else if constexpr (T == kBuildingMaterials) {
+        return FormLists::IsBuildingMaterials(a_obj->GetFormID(), a_lists);
+    } else {
+        static_assert(T != T, "IsOfItemType: missing predicate for item type");
+    }
 }
 
-inline std::function<bool(RE::TESBoundObject*)> GetFilterFunc(const ItemTypes a_itemtype) {
-    switch (a_itemtype) {
-        case kWeapon:
-            return [](const RE::TESBoundObject* a_obj) { return a_obj->Is(RE::FormType::Weapon); };
-        case kAmmo:
-            return [](const RE::TESBoundObject* a_obj) { return a_obj->Is(RE::FormType::Ammo); };
-        case kArmorStrict:
-            return [](RE::TESBoundObject* a_obj) { return FormLists::IsArmorStrict(a_obj); };
-        case kJewelry:
-            return [](const RE::TESBoundObject* a_obj) { return FormLists::IsJewelry(a_obj); };
-        case kShield:
-            return [](RE::TESBoundObject* a_obj) { return FormLists::IsShield(a_obj); };
-        case kClothing:
-            return [](RE::TESBoundObject* a_obj) { return FormLists::IsClothing(a_obj); };
-        case kPoison:
-            return [](RE::TESBoundObject* a_obj) {
-                const auto temp = a_obj->As<RE::AlchemyItem>();
-                return temp && !temp->IsFood() && temp->IsPoison();
-            };
-        case kPotion:
-            return [](RE::TESBoundObject* a_obj) {
-                const auto temp = a_obj->As<RE::AlchemyItem>();
-                return temp && !temp->IsFood() && !temp->IsPoison();
-            };
-        case kScrollItem:
-            return [](const RE::TESBoundObject* a_obj) { return a_obj->Is(RE::FormType::Scroll); };
-        case kFood:
-            return [](const RE::TESBoundObject* a_obj) {
-                const auto alch_item = a_obj->As<RE::AlchemyItem>();
-                return alch_item && alch_item->IsFood();
-            };
-        case kRawFood:
-            return [](const RE::TESBoundObject* a_obj) { return FormLists::IsRawFood(a_obj); };
-        case kCookedFood:
-            return [](const RE::TESBoundObject* a_obj) { return FormLists::IsCookedFood(a_obj->GetFormID()); };
-        case kSweets:
-            return [](const RE::TESBoundObject* a_obj) { return FormLists::IsSweets(a_obj->GetFormID()); };
-        case kDrinks:
-            return [](const RE::TESBoundObject* a_obj) { return FormLists::IsDrinks(a_obj->GetFormID()); };
-        case kIngredient:
-            return [](const RE::TESBoundObject* a_obj) { return a_obj->Is(RE::FormType::Ingredient); };
-        case kBookAll:
-            return [](const RE::TESBoundObject* a_obj) { return a_obj->Is(RE::FormType::Book); };
-        case kBookSkill:
-            return [](RE::TESBoundObject* a_obj) { return FormLists::IsBookSkill(a_obj); };
-        case kBookSpell:
-            return [](RE::TESBoundObject* a_obj) { return FormLists::IsBookSpell(a_obj); };
-        case kBookRecipe:
-            return [](RE::TESBoundObject* a_obj) { return FormLists::IsRecipe(a_obj); };
-        case kBookStrict:
-            return [](RE::TESBoundObject* a_obj) { return FormLists::IsBookStrict(a_obj); };
-        case kKey:
-            return [](const RE::TESBoundObject* a_obj) { return a_obj->Is(RE::FormType::KeyMaster); };
-        case kMiscAll:
-            return [](const RE::TESBoundObject* a_obj) {
-                return a_obj->Is(RE::FormType::Misc) || a_obj->IsSoulGem() || a_obj->Is(RE::FormType::Light);
-            };
-        case kSoulGem:
-            return [](const RE::TESBoundObject* a_obj) { return a_obj->Is(RE::FormType::SoulGem); };
-        case kOres:
-            return [](const RE::TESBoundObject* a_obj) { return FormLists::IsIngotsOres(a_obj); };
-        case kGems:
-            return [](const RE::TESBoundObject* a_obj) { return FormLists::IsGems(a_obj); };
-        case kLeatherNPelts:
-            return [](const RE::TESBoundObject* a_obj) { return FormLists::IsLeatherNPelts(a_obj); };
-        case kBuildingMaterials:
-            return [](const RE::TESBoundObject* a_obj) { return FormLists::IsBuildingMaterials(a_obj->GetFormID()); };
-        default:
-            logger::error("GetFilterFunc: Unknown item type {}", static_cast<int>(a_itemtype));
-            return [](RE::TESBoundObject*) { return false; };
-    }
-}
\ No newline at end of file
+template <std::size_t... I>
+std::uint32_t ClassifyAllItemTypes(RE::TESBoundObject* a_obj, const FormLists::Snapshot& a_lists, std::index_sequence<I...>) {
+    return ((IsOfItemType<static_cast<ItemTypes>(I)>(a_obj, a_lists) ? ItemTypeBit(static_cast<ItemTypes>(I)) : 0u) | ...);
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include "Settings.h"
+
+// Routing table from categories to storage containers, for sorting the player's inventory into many chests at once.
+// Routes hold runtime handles, so they are cleared whenever a save is loaded; scripts set them up again after a load.
+namespace StorageRoutes {
+    void SetRoute(ItemTypes a_type, RE::TESObjectREFR* a_container);
+    void ClearRoute(ItemTypes a_type);
+    void ClearAllRoutes();
+
+    // Walks the player inventory once and sends every routed item to its container, one batch per container.
+    // An item in several routed categories goes to the most specific one (the highest ItemTypes value, e.g.
+    // kRawFood over kFood). Must run on the main thread. Returns the number of containers that receive items.
+    std::size_t StoreByRoutes();
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small work-stealing pool shared by the plugin's parallel jobs (list loading, index building).
+// Every worker owns a deque: it takes its newest task first and, once empty, steals the oldest task of
+// another worker. The thread that submits a batch works on it too instead of idling until it is done.
+class TaskPool {
+public:
+    static TaskPool& GetSingleton();
+
+    // A pool of its own with a_workerCount workers besides the calling thread; 0 runs everything on the caller.
+    // The workers are detached and keep a pointer to the pool, so a pool must never be destroyed.
+    explicit TaskPool(std::size_t a_workerCount);
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    // Threads that run tasks, counting the caller of ParallelFor
+    [[nodiscard]] std::size_t GetConcurrency() const noexcept { return _queues.size(); }
+
+    // Calls a_func(i) for every i in [0, a_count) and returns once all calls finished.
+    // Calls run concurrently and in no particular order.
+    template <typename Func>
+    void ParallelFor(const std::size_t a_count, Func&& a_func) {
+        if (a_count == 0) return;
+        if (a_count == 1 || _workers.empty()) {
+            for (std::size_t i = 0; i < a_count; ++i) a_func(i);
+            return;
+        }
+
+        Batch batch{.run = [](void* a_context, const std::size_t a_index) { (*static_cast<std::remove_reference_t<Func>*>(a_context))(a_index); },
+                    .context = std::addressof(a_func),
+                    .remaining = a_count};
+        Submit(batch, a_count);
+        Help(batch);
+    }
+
+private:
+    struct Batch {
+        void (*run)(void*, std::size_t);
+        void* context;
+        std::atomic<std::size_t> remaining;
+    };
+
+    struct Task {
+        Batch* batch;
+        std::size_t index;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void Submit(Batch& a_batch, std::size_t a_count);
+    // Runs tasks (of any batch) until a_batch has finished
+    void Help(Batch& a_batch);
+    bool TryRunOne(std::size_t a_self);
+    void WorkerLoop(std::size_t a_self);
+
+    // slot 0 belongs to whichever thread is submitting, the rest to the workers
+    std::vector<std::unique_ptr<Queue>> _queues;
+    std::vector<std::thread> _workers;
+
+    std::mutex _sleepMutex;
+    std::condition_variable _wake;
+    std::atomic<std::size_t> _queued{0};
+};
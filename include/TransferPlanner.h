@@ -0,0 +1,146 @@
+#pragma once
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Decides what a transfer moves, working only on a plain snapshot of the source inventory.
+// Does not depend on the game, so the same logic can be driven by a stand-in inventory outside of it.
+namespace TransferPlanner {
+    // One inventory entry that already matched the requested categories
+    struct Entry {
+        std::uint32_t formid = 0;
+        std::int32_t count = 0;  // outfit copies already subtracted
+        float weight = 0.f;
+        std::int32_t value = 0;
+        bool is_protected = false;  // worn, favorited or quest item on the player
+    };
+
+    enum class Selection : std::uint8_t {
+        kGreedy,        // inventory order, stop at the first item that overflows
+        kValueDensity,  // most gold per unit of weight first, skipping what doesn't fit
+    };
+
+    struct Request {
+        float remaining_capacity = FLT_MAX;  // carry capacity left on the target
+        float exclude_weight_limit = 0.f;    // entries lighter than this stay behind (0 disables)
+        Selection selection = Selection::kGreedy;
+    };
+
+    struct PlannedItem {
+        std::uint32_t entry_index = 0;
+        std::int32_t count = 0;
+    };
+
+    // Walks the entries in order and takes as much as fits, stopping at the first item that overflows.
+    inline void PlanGreedy(const std::span<const Entry> a_entries, const Request& a_request, std::vector<PlannedItem>& a_plan) {
+        a_plan.clear();
+        float remaining_capacity = a_request.remaining_capacity;
+
+        for (std::uint32_t i = 0; i < a_entries.size(); ++i) {
+            if (remaining_capacity <= 0.0f) break;
+
+            const auto& entry = a_entries[i];
+            auto count = entry.count;
+            if (count <= 0) {
+                continue;
+            }
+            if (a_request.exclude_weight_limit > 0.f && entry.weight < a_request.exclude_weight_limit) {
+                continue;
+            }
+            if (entry.is_protected) {
+                continue;
+            }
+
+            remaining_capacity -= entry.weight * count;
+            if (remaining_capacity < 0.0f) {
+                count = static_cast<std::int32_t>(std::floor((remaining_capacity + entry.weight * count) / entry.weight));
+                if (count <= 0) break;
+            }
+
+            a_plan.push_back({i, count});
+        }
+    }
+
+    // Fills the remaining capacity with the best value per weight. Weightless entries go first since they cost nothing.
+    // Candidates sit on two heaps, by density and by weight; the second one tells when even the lightest candidate
+    // left no longer fits, which ends the plan. Building both is O(n) and every candidate leaves each heap at most
+    // once, so this is O(n + p log n) for the p candidates popped before that point: the planned ones plus those
+    // that no longer fit. A bounded top-k would need k before planning, but how many entries fit only shows while
+    // the capacity is filled.
+    inline void PlanByValueDensity(const std::span<const Entry> a_entries, const Request& a_request, std::vector<PlannedItem>& a_plan) {
+        a_plan.clear();
+
+        struct Candidate {
+            float key;  // density or weight
+            std::uint32_t index;
+        };
+        // reused by the next plan on this thread
+        thread_local std::vector<Candidate> by_density;
+        thread_local std::vector<Candidate> by_weight;
+        thread_local std::vector<std::uint8_t> popped;  // by entry index
+        by_density.clear();
+        by_weight.clear();
+        popped.assign(a_entries.size(), 0);
+
+        for (std::uint32_t i = 0; i < a_entries.size(); ++i) {
+            const auto& entry = a_entries[i];
+            if (entry.count <= 0 || entry.is_protected) {
+                continue;
+            }
+            if (a_request.exclude_weight_limit > 0.f && entry.weight < a_request.exclude_weight_limit) {
+                continue;
+            }
+            if (entry.weight <= 0.f) {
+                a_plan.push_back({i, entry.count});
+                continue;
+            }
+            if (entry.weight > a_request.remaining_capacity) {
+                continue;  // not even one fits
+            }
+            by_density.push_back({static_cast<float>(entry.value) / entry.weight, i});
+            by_weight.push_back({entry.weight, i});
+        }
+
+        const auto less_dense = [](const Candidate& a_lhs, const Candidate& a_rhs) { return a_lhs.key < a_rhs.key; };
+        const auto heavier = [](const Candidate& a_lhs, const Candidate& a_rhs) { return a_lhs.key > a_rhs.key; };
+        std::ranges::make_heap(by_density, less_dense);
+        std::ranges::make_heap(by_weight, heavier);
+
+        float remaining_capacity = a_request.remaining_capacity;
+        while (!by_density.empty()) {
+            // candidates already taken off the density heap leave the weight heap lazily
+            while (!by_weight.empty() && popped[by_weight.front().index]) {
+                std::ranges::pop_heap(by_weight, heavier);
+                by_weight.pop_back();
+            }
+            if (by_weight.empty() || remaining_capacity < by_weight.front().key) {
+                break;
+            }
+
+            std::ranges::pop_heap(by_density, less_dense);
+            const auto index = by_density.back().index;
+            by_density.pop_back();
+            popped[index] = 1;
+
+            const auto& entry = a_entries[index];
+            const auto fitting = static_cast<std::int32_t>(std::min<float>(static_cast<float>(entry.count), std::floor(remaining_capacity / entry.weight)));
+            if (fitting <= 0) {
+                continue;
+            }
+            remaining_capacity -= entry.weight * static_cast<float>(fitting);
+            a_plan.push_back({index, fitting});
+        }
+    }
+
+    inline void Plan(const std::span<const Entry> a_entries, const Request& a_request, std::vector<PlannedItem>& a_plan) {
+        // without a capacity limit both select everything, and greedy keeps inventory order
+        if (a_request.selection == Selection::kValueDensity && a_request.remaining_capacity < FLT_MAX) {
+            PlanByValueDensity(a_entries, a_request, a_plan);
+        } else {
+            PlanGreedy(a_entries, a_request, a_plan);
+        }
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "Metrics.h"
+#include "ScratchBuffers.h"
+
+// Applies planned transfers across frames so large batches don't stall a single one.
+// Each frame moves items until the per-frame budget is spent and continues on the next frame through the
+// task interface. Batches run in submission order; a reference's inventory menu is refreshed once consecutive
+// batches stop touching it.
+namespace TransferQueue {
+    struct Item {
+        RE::TESBoundObject* object = nullptr;
+        std::int32_t count = 0;
+    };
+    // Taken from Scratch::Acquire<Item>(); handed back to the pool once the batch is applied
+    using Items = Scratch::Vector<Item>;
+
+    // Default per-frame budget; 0 applies every batch in one go
+    inline constexpr std::uint32_t DEFAULT_FRAME_BUDGET_US = 2000;
+
+    void SetFrameBudget(std::uint32_t a_microseconds);
+    [[nodiscard]] std::uint32_t GetFrameBudget();
+
+    // Applies what fits into the budget right away, so small batches finish on the calling frame.
+    // a_timer is finished once the last item is applied, with the apply time of every frame it took.
+    void Submit(RE::TESObjectREFR* a_source, RE::TESObjectREFR* a_target, Items a_items, Metrics::TransferTimer a_timer);
+
+    struct Transfer {
+        RE::TESObjectREFR* target = nullptr;
+        Items items;
+    };
+    // Queues one batch per target together, so menus shared between them are refreshed once at the end; the items
+    // are moved out of a_transfers. a_timer covers all of them and is finished with the last one.
+    void Submit(RE::TESObjectREFR* a_source, std::span<Transfer> a_transfers, Metrics::TransferTimer a_timer);
+
+    // Whether a batch from or to a_ref is still waiting to be applied
+    [[nodiscard]] bool IsQueued(RE::ObjectRefHandle a_ref);
+
+    // Fraction of the queued items that were applied; 1 when nothing is pending
+    [[nodiscard]] float GetProgress();
+}
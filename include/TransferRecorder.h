@@ -0,0 +1,24 @@
+#pragma once
+#include "ContainerIndex.h"
+#include "Settings.h"
+#include "TransferPlanner.h"
+
+// Opt-in recording of transfer requests and the inventories they ran against, in the TransferTrace format.
+// Traces go next to the plugin's log as <name>.qittrace and are replayed offline by tools/TransferReplay.cpp.
+// Nothing is recorded (and nothing costs more than an atomic load) unless a recording was started.
+namespace TransferRecorder {
+    // Starts a new trace, ending the current one first. Returns false if the file cannot be created.
+    bool Start(std::string_view a_name);
+    // Returns the number of records written
+    std::size_t Stop();
+    [[nodiscard]] bool IsRecording() noexcept;
+
+    void RecordRequest(int a_action, int a_subType);
+    // Records the whole playable inventory of a_source as one transfer pass saw it. a_outfit and a_protectSpecials
+    // are the pass's own outfit and worn/favorite/quest item rules. a_indexed is what the container index handed the
+    // pass, empty if it walked the inventory; the matching items are recorded in that order, so a replay collects
+    // them in the same order the live pass did.
+    void RecordSnapshot(RE::TESObjectREFR* a_source, std::uint32_t a_typeMask, const TransferPlanner::Request& a_request,
+                        FormID a_outfit, bool a_protectSpecials, const FormLists::Snapshot& a_lists,
+                        std::span<const ContainerIndex::Candidate> a_indexed);
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+// Entry point for transfer requests coming from Papyrus.
+// Requests for the same container and direction that arrive before the main thread gets to them are merged
+// into one pass over the union of their categories. A request is dropped if the last pass over that source
+// found nothing at all in its categories (not just nothing movable) and nothing was added to or equipped on the
+// source since.
+// A request whose source or target still has an earlier transfer being planned or applied waits for it to finish,
+// so it plans against the inventories and carry weight that transfer leaves behind.
+namespace TransferRequests {
+    // a_taking: container -> player, otherwise player -> container. a_typeMask holds one ItemTypeBit per category.
+    void Submit(bool a_taking, std::uint32_t a_typeMask);
+
+    // Items were added to a_container or its equipment changed (freeing outfit copies), so categories it had run
+    // out of may match again
+    void OnInventoryChanged(RefID a_container);
+    // Forgets which sources ran out; called before a save is loaded
+    void ResetExhausted();
+}
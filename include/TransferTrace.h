@@ -0,0 +1,198 @@
+#pragma once
+#include "TransferPlanner.h"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Binary trace of the transfers players actually request, written by the opt-in recorder in the plugin and read by
+// the offline replay tool. Does not depend on the game. Little-endian, fields packed in this order:
+//   header    "QITT" u32 version
+//   request   u8 kind=1  u64 time_us  i32 action  i32 subtype
+//   snapshot  u8 kind=2  u64 time_us  u32 source  u32 type_mask  f32 remaining_capacity  f32 exclude_weight_limit
+//             u8 selection  u32 item_count, then per item:
+//             u32 formid  i32 count  f32 weight  i32 value  u32 category_mask  u8 flags
+// time_us counts from the start of the recording. A snapshot holds the whole source inventory, not just the
+// requested categories, so a replay runs the category filter as well as the planner. The matching items are in the
+// order the live pass collected them, which decides ties in the planner and where a greedy pass stops collecting.
+namespace TransferTrace {
+    static_assert(std::endian::native == std::endian::little, "traces are written in host byte order");
+
+    constexpr std::array<char, 4> kMagic = {'Q', 'I', 'T', 'T'};
+    constexpr std::uint32_t kVersion = 1;
+
+    // category_mask bit of forms listed in excludes/ (FormLists::kExcludedBit)
+    constexpr std::uint32_t kExcludedBit = 1u << 31;
+
+    enum class RecordKind : std::uint8_t { kRequest = 1, kSnapshot = 2 };
+
+    // One StartTransfer call, or one pair of a StartTransferMulti call
+    struct Request {
+        std::uint64_t time_us = 0;
+        std::int32_t action = 0;
+        std::int32_t subtype = 0;
+    };
+
+    struct Item {
+        std::uint32_t formid = 0;
+        std::int32_t count = 0;  // outfit copies already subtracted
+        float weight = 0.f;
+        std::int32_t value = 0;
+        std::uint32_t category_mask = 0;
+        bool is_protected = false;
+    };
+
+    // The source inventory as one transfer pass saw it
+    struct Snapshot {
+        std::uint64_t time_us = 0;
+        std::uint32_t source = 0;
+        std::uint32_t type_mask = 0;
+        TransferPlanner::Request request;
+        std::vector<Item> items;
+    };
+
+    // The entries a transfer pass would hand to the planner for a_request: requested categories, nothing excluded,
+    // nothing under the weight limit. Like the live pass, a greedy selection stops collecting once the movable
+    // weight collected covers the remaining capacity, since nothing after that could be taken.
+    inline void Filter(const Snapshot& a_snapshot, const TransferPlanner::Request& a_request, std::vector<TransferPlanner::Entry>& a_entries) {
+        a_entries.clear();
+        float claimed_weight = 0.f;
+        for (const auto& item : a_snapshot.items) {
+            if ((item.category_mask & kExcludedBit) || !(item.category_mask & a_snapshot.type_mask)) continue;
+            if (a_request.exclude_weight_limit > 0.f && item.weight < a_request.exclude_weight_limit) continue;
+            a_entries.push_back({.formid = item.formid,
+                                 .count = item.count,
+                                 .weight = item.weight,
+                                 .value = item.value,
+                                 .is_protected = item.is_protected});
+            if (item.count > 0 && !item.is_protected) {
+                claimed_weight += item.weight * static_cast<float>(item.count);
+            }
+            if (a_request.selection == TransferPlanner::Selection::kGreedy && claimed_weight >= a_request.remaining_capacity) break;
+        }
+    }
+
+    // Encodes records into a byte buffer; the caller writes Data() out and calls Clear()
+    class Writer {
+    public:
+        void WriteHeader() {
+            _buffer.append(kMagic.data(), kMagic.size());
+            Put(kVersion);
+        }
+
+        void Write(const Request& a_request) {
+            Put(RecordKind::kRequest);
+            Put(a_request.time_us);
+            Put(a_request.action);
+            Put(a_request.subtype);
+        }
+
+        void Write(const Snapshot& a_snapshot) {
+            Put(RecordKind::kSnapshot);
+            Put(a_snapshot.time_us);
+            Put(a_snapshot.source);
+            Put(a_snapshot.type_mask);
+            Put(a_snapshot.request.remaining_capacity);
+            Put(a_snapshot.request.exclude_weight_limit);
+            Put(a_snapshot.request.selection);
+            Put(static_cast<std::uint32_t>(a_snapshot.items.size()));
+            for (const auto& item : a_snapshot.items) {
+                Put(item.formid);
+                Put(item.count);
+                Put(item.weight);
+                Put(item.value);
+                Put(item.category_mask);
+                Put(static_cast<std::uint8_t>(item.is_protected ? 1 : 0));
+            }
+        }
+
+        [[nodiscard]] std::string_view Data() const { return _buffer; }
+        void Clear() { _buffer.clear(); }
+
+    private:
+        template <typename T>
+        void Put(const T a_value) {
+            const auto offset = _buffer.size();
+            _buffer.resize(offset + sizeof(T));
+            std::memcpy(_buffer.data() + offset, &a_value, sizeof(T));
+        }
+
+        std::string _buffer;
+    };
+
+    // Decodes a whole trace held in memory
+    class Reader {
+    public:
+        explicit Reader(const std::string_view a_bytes) : _bytes(a_bytes) {}
+
+        bool ReadHeader(std::string& a_error) {
+            std::array<char, 4> magic{};
+            std::uint32_t version = 0;
+            if (!Get(magic) || magic != kMagic) {
+                a_error = "not a transfer trace";
+                return false;
+            }
+            if (!Get(version) || version != kVersion) {
+                a_error = "unsupported trace version " + std::to_string(version);
+                return false;
+            }
+            return true;
+        }
+
+        // Reads the next record into a_request or a_snapshot, depending on a_kind. Returns false at the end of
+        // the trace; a_error is set if it ended inside a record (a recording cut short by a crash).
+        bool Next(RecordKind& a_kind, Request& a_request, Snapshot& a_snapshot, std::string& a_error) {
+            if (_bytes.empty()) return false;
+            const auto truncated = [&]() {
+                a_error = "trace ends inside a record";
+                return false;
+            };
+
+            if (!Get(a_kind)) return truncated();
+            switch (a_kind) {
+                case RecordKind::kRequest:
+                    if (!Get(a_request.time_us) || !Get(a_request.action) || !Get(a_request.subtype)) return truncated();
+                    return true;
+                case RecordKind::kSnapshot: {
+                    std::uint32_t item_count = 0;
+                    if (!Get(a_snapshot.time_us) || !Get(a_snapshot.source) || !Get(a_snapshot.type_mask) ||
+                        !Get(a_snapshot.request.remaining_capacity) || !Get(a_snapshot.request.exclude_weight_limit) ||
+                        !Get(a_snapshot.request.selection) || !Get(item_count) || _bytes.size() / kItemSize < item_count) {
+                        return truncated();
+                    }
+                    a_snapshot.items.resize(item_count);
+                    for (auto& item : a_snapshot.items) {
+                        std::uint8_t flags = 0;
+                        if (!Get(item.formid) || !Get(item.count) || !Get(item.weight) || !Get(item.value) ||
+                            !Get(item.category_mask) || !Get(flags)) {
+                            return truncated();
+                        }
+                        item.is_protected = flags & 1;
+                    }
+                    return true;
+                }
+            }
+            a_error = "unknown record kind " + std::to_string(static_cast<int>(a_kind));
+            return false;
+        }
+
+    private:
+        // bytes per item record: formid, count, weight, value, category_mask, flags
+        static constexpr std::size_t kItemSize = sizeof(Item::formid) + sizeof(Item::count) + sizeof(Item::weight) +
+                                                 sizeof(Item::value) + sizeof(Item::category_mask) + sizeof(std::uint8_t);
+
+        template <typename T>
+        bool Get(T& a_value) {
+            if (_bytes.size() < sizeof(T)) return false;
+            std::memcpy(&a_value, _bytes.data(), sizeof(T));
+            _bytes.remove_prefix(sizeof(T));
+            return true;
+        }
+
+        std::string_view _bytes;
+    };
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "Metrics.h"
+#include "ScratchBuffers.h"
+#include "TransferPlanner.h"
+
+// Plans transfers away from the game and scripting threads.
+// The inventory snapshot is taken on the main thread; a worker turns it into a plan and the plan is
+// committed back on the main thread through the task interface.
+namespace TransferWorker {
+    struct Job {
+        RE::ObjectRefHandle source;
+        RE::ObjectRefHandle target;
+        // the open container menu's reference when the job was made, if it is part of the transfer.
+        // The plan is thrown away if that menu is gone by the time it would be committed.
+        RE::ObjectRefHandle menu_container;
+
+        // taken from Scratch::Acquire(); the worker hands them back once the plan is made
+        Scratch::Vector<TransferPlanner::Entry> entries;
+        Scratch::Vector<RE::TESBoundObject*> objects;  // parallel to entries
+        TransferPlanner::Request request;
+
+        Metrics::TransferTimer timer;
+        std::size_t scanned = 0;
+    };
+
+    void Enqueue(Job a_job);
+
+    // Whether a_ref is the source or target of a job that was enqueued but not committed yet. Main thread only.
+    [[nodiscard]] bool IsPending(RE::ObjectRefHandle a_ref);
+}
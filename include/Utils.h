@@ -4,9 +4,48 @@
 namespace Utils {
     RE::TESObjectREFR* GetMenuContainer();
 
-    void TransferItemsOfType(RE::TESObjectREFR* akSource, RE::TESObjectREFR* akTarget, ItemTypes item_type);
+    // Both return how many matching entries the source holds, movable right now or not (0 when it has nothing left
+    // in those categories)
+    std::size_t TransferItemsOfType(RE::TESObjectREFR* akSource, RE::TESObjectREFR* akTarget, ItemTypes item_type);
+    // Single inventory pass over every category set in type_mask (one ItemTypeBit per category)
+    std::size_t TransferItemsOfTypes(RE::TESObjectREFR* akSource, RE::TESObjectREFR* akTarget, std::uint32_t type_mask);
+
+    bool IsTakingAction(int iAction);
+    ItemTypes GetItemType(int iAction, int iSubType);
 
     void StartTransfer(RE::StaticFunctionTag*, int iAction, int iSubType = 0);
+    // Papyrus: takes parallel (iAction, iSubType) arrays; all actions must share one direction
+    void StartTransferMulti(RE::StaticFunctionTag*, std::vector<int> aiActions, std::vector<int> aiSubTypes);
+
+    // Papyrus: re-reads every category TXT file and swaps in the new lists. Returns the time taken in ms.
+    float ReloadFormLists(RE::StaticFunctionTag*);
+    // Papyrus: watch the category folders while the game runs and reload edited TXT files (off by default)
+    void SetFormListWatching(RE::StaticFunctionTag*, bool abEnabled);
+
+    // Papyrus: logs the transfer and loading timings and returns the same text
+    std::string GetPerformanceReport(RE::StaticFunctionTag*);
+    // Papyrus: latency percentile (ms) of whole transfers for the category an (iAction, iSubType) pair maps to.
+    // Pairs that map to no category report multi-category transfers.
+    float GetTransferLatency(RE::StaticFunctionTag*, int iAction, int iSubType, float afPercentile);
+
+    // Papyrus: per-frame time budget for applying large transfers, in microseconds (0 moves everything at once)
+    void SetTransferFrameBudget(RE::StaticFunctionTag*, int aiMicroseconds);
+    // Papyrus: 0..1 progress of the transfers still being applied, 1 when idle
+    float GetTransferProgress(RE::StaticFunctionTag*);
+
+    // Papyrus: when a follower can't carry everything, take the most valuable items per weight first
+    void SetValueDensitySelection(RE::StaticFunctionTag*, bool abEnabled);
+
+    // Papyrus: routes the category of an (iAction, iSubType) pair to akContainer; None removes the route
+    void SetStorageRoute(RE::StaticFunctionTag*, int iAction, int iSubType, RE::TESObjectREFR* akContainer);
+    void ClearStorageRoutes(RE::StaticFunctionTag*);
+    // Papyrus: stores every routed item from the player inventory into its container in one pass
+    void StoreByRoutes(RE::StaticFunctionTag*);
+
+    // Papyrus: records transfer requests and source inventories to <log folder>/<asName>.qittrace for offline
+    // replay, until StopTransferRecording() (which returns the number of records written)
+    bool StartTransferRecording(RE::StaticFunctionTag*, std::string asName);
+    int StopTransferRecording(RE::StaticFunctionTag*);
 
     bool PapyrusFunctions(RE::BSScript::IVirtualMachine* vm);
 
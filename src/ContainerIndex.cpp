@@ -0,0 +1,186 @@
+#include "ContainerIndex.h"
+#include "InventoryVisitor.h"
+#include <bit>
+
+namespace {
+    constexpr RefID PLAYER_REF_ID = 0x14;
+
+    struct IndexedItem {
+        RE::TESBoundObject* object = nullptr;
+        std::int32_t count = 0;
+        std::uint32_t mask = 0;
+    };
+
+    struct Index {
+        bool stale = true;
+        std::weak_ptr<const FormLists::Snapshot> lists;
+        // items whose count dropped to zero keep their entry until the next rebuild
+        std::unordered_map<FormID, IndexedItem> items;
+        // FormIDs per ItemTypes value, so single-category lookups don't touch unrelated items
+        std::array<std::unordered_set<FormID>, kNone> by_type;
+
+        void Clear() {
+            items.clear();
+            for (auto& bucket : by_type) bucket.clear();
+        }
+
+        void Add(const FormID a_formid, const IndexedItem& a_item) {
+            items.insert_or_assign(a_formid, a_item);
+            for (auto bits = a_item.mask & ~FormLists::kExcludedBit; bits; bits &= bits - 1) {
+                if (const auto type = std::countr_zero(bits); type < kNone) by_type[type].insert(a_formid);
+            }
+        }
+    };
+
+    std::mutex g_indexMutex;
+    std::unordered_map<RefID, Index> g_indexes;
+
+    // Same items the transfer loop considers at all
+    bool IsIndexable(const RE::TESBoundObject* a_item) {
+        return a_item && !a_item->Is(RE::FormType::LeveledItem) && a_item->GetPlayable();
+    }
+
+    void Rebuild(RE::TESObjectREFR* a_ref, Index& a_index, const std::shared_ptr<const FormLists::Snapshot>& a_lists) {
+        a_index.Clear();
+        Inventory::ForEachItem(a_ref, IsIndexable, [&](RE::TESBoundObject* a_item, const std::int32_t a_count,
+                                                         const RE::InventoryEntryData*) {
+            a_index.Add(a_item->GetFormID(), {.object = a_item, .count = a_count, .mask = FormLists::GetCategoryMask(a_item, *a_lists)});
+            return true;
+        });
+        a_index.lists = a_lists;
+        a_index.stale = false;
+    }
+
+#ifdef QIT_VERIFY_CONTAINER_INDEX
+    // Compares the incrementally kept index against a fresh one and keeps the fresh one on mismatch
+    void Verify(RE::TESObjectREFR* a_ref, Index& a_index, const std::shared_ptr<const FormLists::Snapshot>& a_lists) {
+        Index fresh;
+        Rebuild(a_ref, fresh, a_lists);
+
+        std::size_t mismatches = 0;
+        for (const auto& [formid, item] : fresh.items) {
+            const auto it = a_index.items.find(formid);
+            if (it == a_index.items.end() || it->second.count != item.count || it->second.mask != item.mask) {
+                logger::warn("ContainerIndex {:x}: {:x} indexed as {} (mask {:x}), inventory has {} (mask {:x})", a_ref->GetFormID(),
+                             formid, it != a_index.items.end() ? it->second.count : 0, it != a_index.items.end() ? it->second.mask : 0,
+                             item.count, item.mask);
+                ++mismatches;
+            }
+        }
+        for (const auto& [formid, item] : a_index.items) {
+            if (item.count > 0 && !fresh.items.contains(formid)) {
+                logger::warn("ContainerIndex {:x}: {:x} indexed as {} but not in the inventory", a_ref->GetFormID(), formid, item.count);
+                ++mismatches;
+            }
+        }
+        if (mismatches) {
+            a_index = std::move(fresh);
+        }
+    }
+#endif
+
+    void ApplyDelta(const RefID a_ref, const FormID a_formid, const std::int32_t a_delta) {
+        const auto it = g_indexes.find(a_ref);
+        if (it == g_indexes.end() || it->second.stale) return;
+        auto& index = it->second;
+
+        if (const auto item = index.items.find(a_formid); item != index.items.end()) {
+            const auto count = item->second.count + a_delta;
+            if (count < 0) {
+                logger::debug("ContainerIndex {:x}: {:x} dropped below zero, rebuilding", a_ref, a_formid);
+                index.stale = true;
+            } else {
+                // an emptied entry stays, so an item that comes back reuses it instead of allocating again
+                item->second.count = count;
+            }
+            return;
+        }
+
+        const auto object = RE::TESForm::LookupByID<RE::TESBoundObject>(a_formid);
+        if (!IsIndexable(object)) return;
+        const auto lists = index.lists.lock();
+        if (a_delta < 0 || !lists) {
+            // removing something the index never saw
+            index.stale = true;
+            return;
+        }
+        index.Add(a_formid, {.object = object, .count = a_delta, .mask = FormLists::GetCategoryMask(object, *lists)});
+    }
+}
+
+void ContainerIndex::Track(const RefID a_ref) {
+    std::lock_guard lock(g_indexMutex);
+    g_indexes.try_emplace(a_ref);
+}
+
+void ContainerIndex::Untrack(const RefID a_ref) {
+    if (a_ref == PLAYER_REF_ID) return;
+    std::lock_guard lock(g_indexMutex);
+    g_indexes.erase(a_ref);
+}
+
+void ContainerIndex::Reset() {
+    std::lock_guard lock(g_indexMutex);
+    g_indexes.clear();
+}
+
+void ContainerIndex::OnContainerChanged(const RefID a_oldContainer, const RefID a_newContainer, const FormID a_item,
+                                        const std::int32_t a_count) {
+    if (a_count <= 0) return;
+    std::lock_guard lock(g_indexMutex);
+    if (a_oldContainer) ApplyDelta(a_oldContainer, a_item, -a_count);
+    if (a_newContainer) ApplyDelta(a_newContainer, a_item, a_count);
+}
+
+bool ContainerIndex::Lookup(RE::TESObjectREFR* a_ref, const std::uint32_t a_typeMask, const bool a_withEntries,
+                            Scratch::Vector<Candidate>& a_out) {
+    a_out.clear();
+    const auto lists = FormLists::GetSnapshot();
+
+    std::lock_guard lock(g_indexMutex);
+    if (a_ref->IsPlayerRef()) {
+        g_indexes.try_emplace(PLAYER_REF_ID);
+    }
+    const auto it = g_indexes.find(a_ref->GetFormID());
+    if (it == g_indexes.end()) return false;
+    auto& index = it->second;
+
+    if (index.stale || index.lists.lock() != lists) {
+        Rebuild(a_ref, index, lists);
+    }
+#ifdef QIT_VERIFY_CONTAINER_INDEX
+    else {
+        Verify(a_ref, index, lists);
+    }
+#endif
+
+    const auto add = [&](const IndexedItem& a_item) {
+        if (a_item.count > 0 && !(a_item.mask & FormLists::kExcludedBit) && (a_item.mask & a_typeMask)) {
+            a_out.push_back({.object = a_item.object, .count = a_item.count});
+        }
+    };
+    if (std::has_single_bit(a_typeMask) && std::countr_zero(a_typeMask) < kNone) {
+        for (const auto formid : index.by_type[std::countr_zero(a_typeMask)]) {
+            add(index.items.at(formid));
+        }
+    } else {
+        for (const auto& item : index.items | std::views::values) {
+            add(item);
+        }
+    }
+
+    if (a_withEntries && !a_out.empty()) {
+        // one pass over the change entries, probing the (few) candidates sorted by object
+        std::ranges::sort(a_out, {}, &Candidate::object);
+        if (const auto changes = a_ref->GetInventoryChanges(); changes && changes->entryList) {
+            for (const auto entry : *changes->entryList) {
+                if (!entry || !entry->object) continue;
+                const auto candidate = std::ranges::lower_bound(a_out, entry->object, {}, &Candidate::object);
+                if (candidate != a_out.end() && candidate->object == entry->object) {
+                    candidate->entry = entry;
+                }
+            }
+        }
+    }
+    return true;
+}
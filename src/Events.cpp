@@ -0,0 +1,52 @@
+#include "Events.h"
+#include "ContainerIndex.h"
+#include "OutfitCache.h"
+#include "Utils.h"
+#include "TransferRequests.h"
+
+RE::BSEventNotifyControl Events::EventSink::ProcessEvent(const RE::TESContainerChangedEvent* a_event,
+                                                         RE::BSTEventSource<RE::TESContainerChangedEvent>*) {
+    if (a_event) {
+        ContainerIndex::OnContainerChanged(a_event->oldContainer, a_event->newContainer, a_event->baseObj, a_event->itemCount);
+        if (a_event->oldContainer) OutfitCache::Invalidate(a_event->oldContainer, a_event->baseObj);
+        if (a_event->newContainer) {
+            OutfitCache::Invalidate(a_event->newContainer, a_event->baseObj);
+            TransferRequests::OnInventoryChanged(a_event->newContainer);
+        }
+    }
+    return RE::BSEventNotifyControl::kContinue;
+}
+
+RE::BSEventNotifyControl Events::EventSink::ProcessEvent(const RE::TESEquipEvent* a_event,
+                                                         RE::BSTEventSource<RE::TESEquipEvent>*) {
+    if (a_event && a_event->actor) {
+        OutfitCache::Invalidate(a_event->actor->GetFormID(), a_event->baseObject);
+        TransferRequests::OnInventoryChanged(a_event->actor->GetFormID());
+    }
+    return RE::BSEventNotifyControl::kContinue;
+}
+
+RE::BSEventNotifyControl Events::EventSink::ProcessEvent(const RE::MenuOpenCloseEvent* a_event,
+                                                         RE::BSTEventSource<RE::MenuOpenCloseEvent>*) {
+    if (!a_event || a_event->menuName != RE::ContainerMenu::MENU_NAME) {
+        return RE::BSEventNotifyControl::kContinue;
+    }
+    if (a_event->opening) {
+        if (const auto container = Utils::GetMenuContainer()) {
+            _menuContainer = container->GetFormID();
+            ContainerIndex::Track(_menuContainer);
+        }
+    } else if (_menuContainer) {
+        ContainerIndex::Untrack(_menuContainer);
+        _menuContainer = 0;
+    }
+    return RE::BSEventNotifyControl::kContinue;
+}
+
+void Events::Install() {
+    const auto holder = RE::ScriptEventSourceHolder::GetSingleton();
+    holder->AddEventSink<RE::TESContainerChangedEvent>(EventSink::GetSingleton());
+    holder->AddEventSink<RE::TESEquipEvent>(EventSink::GetSingleton());
+    RE::UI::GetSingleton()->AddEventSink<RE::MenuOpenCloseEvent>(EventSink::GetSingleton());
+    logger::info("Event sinks installed");
+}
@@ -0,0 +1,186 @@
+#include "FormListCache.h"
+#include "FormListParser.h"
+
+namespace {
+    constexpr std::uint32_t CACHE_MAGIC = 0x43544951;  // "QITC"
+    constexpr std::uint32_t CACHE_VERSION = 4;
+
+    class Writer {
+    public:
+        explicit Writer(std::ofstream& a_stream) : _stream(a_stream) {}
+
+        template <typename T>
+            requires std::is_trivially_copyable_v<T>
+        void Write(const T& a_value) {
+            _stream.write(reinterpret_cast<const char*>(&a_value), sizeof(T));
+        }
+
+        void Write(const std::string_view a_str) {
+            Write(static_cast<std::uint32_t>(a_str.size()));
+            _stream.write(a_str.data(), static_cast<std::streamsize>(a_str.size()));
+        }
+
+    private:
+        std::ofstream& _stream;
+    };
+
+    // Bounds-checked reader over the cache file contents
+    class Reader {
+    public:
+        explicit Reader(const std::string_view a_data) : _data(a_data) {}
+
+        template <typename T>
+            requires std::is_trivially_copyable_v<T>
+        bool Read(T& a_value) {
+            if (_data.size() < sizeof(T)) return false;
+            std::memcpy(&a_value, _data.data(), sizeof(T));
+            _data.remove_prefix(sizeof(T));
+            return true;
+        }
+
+        bool Read(std::string& a_str) {
+            std::uint32_t size = 0;
+            if (!Read(size) || _data.size() < size) return false;
+            a_str.assign(_data.substr(0, size));
+            _data.remove_prefix(size);
+            return true;
+        }
+
+        bool Read(std::vector<FormID>& a_forms) {
+            std::uint32_t count = 0;
+            if (!Read(count) || _data.size() / sizeof(FormID) < count) return false;
+            a_forms.resize(count);
+            std::memcpy(a_forms.data(), _data.data(), count * sizeof(FormID));
+            _data.remove_prefix(count * sizeof(FormID));
+            return true;
+        }
+
+        bool Read(std::vector<std::string>& a_strings) {
+            std::uint32_t count = 0;
+            if (!Read(count) || _data.size() / sizeof(std::uint32_t) < count) return false;
+            a_strings.resize(count);
+            return std::ranges::all_of(a_strings, [this](std::string& a_str) { return Read(a_str); });
+        }
+
+    private:
+        std::string_view _data;
+    };
+}
+
+std::uint64_t FormListCache::GetLoadOrderFingerprint() {
+    const auto data_handler = RE::TESDataHandler::GetSingleton();
+    std::uint64_t hash = FormListParser::HashBytes({});
+
+    // a plugin updated in place keeps its name and slot, so its size and mtime are part of the fingerprint too
+    const auto hash_file = [&hash](const RE::TESFile* a_file, const std::uint32_t a_index) {
+        if (!a_file) return;
+        const auto filename = a_file->GetFilename();
+        const auto path = std::filesystem::path("Data") / filename;
+        std::uint64_t fields[] = {a_index, 0, 0};
+        std::error_code ec;
+        if (const auto size = std::filesystem::file_size(path, ec); !ec) {
+            fields[1] = size;
+        }
+        if (const auto mtime = std::filesystem::last_write_time(path, ec); !ec) {
+            fields[2] = static_cast<std::uint64_t>(mtime.time_since_epoch().count());
+        }
+        hash = FormListParser::HashBytes(filename, hash);
+        hash = FormListParser::HashBytes({reinterpret_cast<const char*>(fields), sizeof(fields)}, hash);
+    };
+
+    const auto mod_count = data_handler->GetLoadedModCount();
+    for (std::uint8_t i = 0; i < mod_count; ++i) {
+        hash_file(data_handler->LookupLoadedModByIndex(i), i);
+    }
+    const auto light_mod_count = data_handler->GetLoadedLightModCount();
+    for (std::uint16_t i = 0; i < light_mod_count; ++i) {
+        hash_file(data_handler->LookupLoadedLightModByIndex(i), 0x10000u | i);
+    }
+    return hash;
+}
+
+std::optional<FormListCache::SourceFile> FormListCache::DescribeFile(const std::filesystem::path& a_path,
+                                                                     const std::string_view a_contents) {
+    std::error_code ec;
+    const auto mtime = std::filesystem::last_write_time(a_path, ec);
+    if (ec) return std::nullopt;
+
+    return SourceFile{.path = a_path.generic_string(),
+                      .size = a_contents.size(),
+                      .mtime = static_cast<std::int64_t>(mtime.time_since_epoch().count()),
+                      .content_hash = FormListParser::HashBytes(a_contents)};
+}
+
+std::optional<FormListCache::Contents> FormListCache::Load(const std::filesystem::path& a_cache_path) {
+    std::string data;
+    if (!std::filesystem::exists(a_cache_path) || !FormListParser::ReadFile(a_cache_path, data)) {
+        return std::nullopt;
+    }
+
+    Reader reader(data);
+    std::uint32_t magic = 0;
+    std::uint32_t version = 0;
+    if (!reader.Read(magic) || magic != CACHE_MAGIC || !reader.Read(version) || version != CACHE_VERSION) {
+        logger::info("Form list cache has an unknown format, rebuilding");
+        return std::nullopt;
+    }
+
+    Contents contents;
+    std::uint32_t file_count = 0;
+    if (!reader.Read(contents.load_order_hash) || !reader.Read(file_count)) return std::nullopt;
+
+    contents.files.reserve(file_count);
+    for (std::uint32_t i = 0; i < file_count; ++i) {
+        auto& [source, category, entry_count, forms, rules] = contents.files.emplace_back();
+        if (!reader.Read(source.path) || !reader.Read(source.size) || !reader.Read(source.mtime) ||
+            !reader.Read(source.content_hash) || !reader.Read(category) || !reader.Read(entry_count) || !reader.Read(forms) ||
+            !reader.Read(rules)) {
+            logger::warn("Form list cache is truncated, rebuilding");
+            return std::nullopt;
+        }
+    }
+    return contents;
+}
+
+void FormListCache::Save(const std::filesystem::path& a_cache_path, const std::uint64_t a_load_order_hash,
+                         const std::vector<CachedFile>& a_files) {
+    auto temp_path = a_cache_path;
+    temp_path += ".tmp";
+    {
+        std::ofstream stream(temp_path, std::ios::binary | std::ios::trunc);
+        if (!stream.is_open()) {
+            logger::warn("Failed to write form list cache {}", temp_path.string());
+            return;
+        }
+
+        Writer writer(stream);
+        writer.Write(CACHE_MAGIC);
+        writer.Write(CACHE_VERSION);
+        writer.Write(a_load_order_hash);
+        writer.Write(static_cast<std::uint32_t>(a_files.size()));
+        for (const auto& [source, category, entry_count, forms, rules] : a_files) {
+            writer.Write(std::string_view(source.path));
+            writer.Write(source.size);
+            writer.Write(source.mtime);
+            writer.Write(source.content_hash);
+            writer.Write(std::string_view(category));
+            writer.Write(entry_count);
+            writer.Write(static_cast<std::uint32_t>(forms.size()));
+            stream.write(reinterpret_cast<const char*>(forms.data()), static_cast<std::streamsize>(forms.size() * sizeof(FormID)));
+            writer.Write(static_cast<std::uint32_t>(rules.size()));
+            for (const auto& rule : rules) {
+                writer.Write(std::string_view(rule));
+            }
+        }
+        if (!stream.good()) {
+            logger::warn("Failed to write form list cache {}", temp_path.string());
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path, a_cache_path, ec);
+    if (ec) {
+        logger::warn("Failed to replace form list cache {}: {}", a_cache_path.string(), ec.message());
+    }
+}
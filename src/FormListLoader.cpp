@@ -0,0 +1,677 @@
+#include "Settings.h"
+#include "CLibUtilsQTR/FormReader.hpp"
+#include "FormListCache.h"
+#include "FormListParser.h"
+#include "Metrics.h"
+#include "RuleProgram.h"
+#include "TaskPool.h"
+#include <future>
+#include <thread>
+#include <atomic>
+
+namespace {
+    constexpr auto TXT_BASE_FOLDER = "Data/SKSE/Plugins/QuickItemTransfer";
+    constexpr auto CACHE_FILE_NAME = "formlists.cache";
+    constexpr auto WATCH_INTERVAL = std::chrono::seconds(2);
+
+    using Clock = std::chrono::steady_clock;
+
+    double ToMilliseconds(const Clock::duration a_duration) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(a_duration).count() / 1000.0;
+    }
+
+    struct CategoryMapping {
+        std::string_view category_folder;
+        FrozenFormSet FormLists::Snapshot::* target_list;
+    };
+
+    constexpr std::array<CategoryMapping, 6> category_mappings = {{
+        {"raw_food", &FormLists::Snapshot::raw_food},
+        {"cooked_food", &FormLists::Snapshot::cooked_food},
+        {"sweets", &FormLists::Snapshot::sweets},
+        {"drinks", &FormLists::Snapshot::drinks},
+        {"building_materials", &FormLists::Snapshot::building_materials},
+        {"excludes", &FormLists::Snapshot::excluded_forms},
+    }};
+    static_assert(std::ranges::equal(category_mappings | std::views::transform(&CategoryMapping::category_folder),
+                                     FormListParser::kCategoryFolders),
+                  "offline tools read the folder names from FormListParser");
+
+    // A TXT file read and split into entries, ready for FormID resolution once the data handler is up
+    struct ParsedFile {
+        struct Entry {
+            std::uint32_t offset;
+            std::uint32_t length;
+            std::uint32_t line_number;
+        };
+
+        std::filesystem::path filepath;
+        std::size_t category = 0;
+        FormListCache::SourceFile source;
+        std::string buffer;
+        std::vector<Entry> entries;
+        Clock::duration parse_time{};
+        bool unread = false;  // size and mtime matched the cache, so only source is filled in
+
+        std::string_view GetEntry(const Entry& a_entry) const { return {buffer.data() + a_entry.offset, a_entry.length}; }
+    };
+
+    struct ParsedFormLists {
+        std::vector<ParsedFile> files;
+        std::optional<FormListCache::Contents> cache;
+        Clock::time_point started;
+        Clock::time_point finished;
+    };
+
+    std::future<ParsedFormLists> g_parseJob;
+
+    using ResolvedFiles = std::map<std::string, FormListCache::CachedFile>;
+    using RuleMatches = std::map<std::string, std::vector<FormID>>;
+
+    // Resolved contents of every TXT file currently on disk, keyed by path. Guarded by g_reloadMutex, which the
+    // main thread only takes at kDataLoaded: a reload can hold it for as long as re-resolving takes.
+    std::mutex g_reloadMutex;
+    ResolvedFiles g_resolvedFiles;
+    std::uint64_t g_loadOrderHash = 0;
+
+    // What the rules of each file matched, keyed by path. Evaluated on the main thread on every load and rule edit
+    // and swapped in whole, never cached.
+    std::atomic<std::shared_ptr<const RuleMatches>> g_ruleMatches;
+
+    // Copy of g_resolvedFiles waiting for the main thread to run its rules and publish it, and whether a task to
+    // do so is queued or running
+    std::atomic<std::shared_ptr<const ResolvedFiles>> g_pendingRuleRun;
+    std::atomic<bool> g_ruleRunQueued{false};
+
+    struct CategoryFile {
+        std::filesystem::path filepath;
+        std::size_t category;
+    };
+
+    std::vector<CategoryFile> ListCategoryFiles(const bool a_warnMissing) {
+        std::vector<CategoryFile> files;
+        for (std::size_t category = 0; category < category_mappings.size(); ++category) {
+            const auto dirpath = std::filesystem::path(TXT_BASE_FOLDER) / category_mappings[category].category_folder;
+
+            std::error_code ec;
+            if (!std::filesystem::exists(dirpath, ec)) {
+                if (a_warnMissing) {
+                    logger::warn("Category folder not found: {}", dirpath.string());
+                }
+                continue;
+            }
+
+            for (std::filesystem::directory_iterator it(dirpath, ec), end; !ec && it != end; it.increment(ec)) {
+                if (!it->is_regular_file(ec)) {
+                    continue;
+                }
+
+                const auto& path = it->path();
+                if (!path.has_extension() || path.extension() != ".txt") {
+                    continue;
+                }
+
+                files.push_back({path, category});
+            }
+        }
+        return files;
+    }
+
+    std::optional<ParsedFile> ParseFile(const std::filesystem::path& filepath, const std::size_t category) {
+        const auto start = Clock::now();
+        ParsedFile parsed{.filepath = filepath, .category = category};
+        if (!FormListParser::ReadFile(filepath, parsed.buffer)) {
+            logger::error("Failed to open TXT file: {}", filepath.string());
+            return std::nullopt;
+        }
+        auto source = FormListCache::DescribeFile(filepath, parsed.buffer);
+        if (!source) {
+            return std::nullopt;
+        }
+        parsed.source = std::move(*source);
+
+        const auto base = parsed.buffer.data();
+        FormListParser::ForEachEntry(parsed.buffer, [&](const std::string_view entry, const std::uint32_t line_number) {
+            parsed.entries.push_back({static_cast<std::uint32_t>(entry.data() - base), static_cast<std::uint32_t>(entry.size()), line_number});
+        });
+        parsed.parse_time = Clock::now() - start;
+        return parsed;
+    }
+
+    bool IsUnchangedOnDisk(const std::filesystem::path& a_path, const FormListCache::SourceFile& a_source) {
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(a_path, ec);
+        if (ec || size != a_source.size) return false;
+        const auto mtime = std::filesystem::last_write_time(a_path, ec);
+        return !ec && static_cast<std::int64_t>(mtime.time_since_epoch().count()) == a_source.mtime;
+    }
+
+    // Filesystem scan and text parsing only; safe to run before kDataLoaded.
+    // Files whose size and mtime match the cache are not read; whether the cache applies to this load order is
+    // only known at kDataLoaded, which reads them after all if it does not.
+    ParsedFormLists ParseAllFormLists() {
+        ParsedFormLists result;
+        result.started = Clock::now();
+
+        std::filesystem::create_directories(TXT_BASE_FOLDER);
+
+        result.cache = FormListCache::Load(std::filesystem::path(TXT_BASE_FOLDER) / CACHE_FILE_NAME);
+        std::unordered_map<std::string, const FormListCache::CachedFile*> cached;
+        if (result.cache) {
+            for (const auto& file : result.cache->files) {
+                cached.emplace(file.source.path, &file);
+            }
+        }
+
+        for (const auto& [filepath, category] : ListCategoryFiles(true)) {
+            const auto start = Clock::now();
+            const auto it = cached.find(filepath.generic_string());
+            if (it != cached.end() && it->second->category == category_mappings[category].category_folder &&
+                IsUnchangedOnDisk(filepath, it->second->source)) {
+                result.files.push_back({.filepath = filepath, .category = category, .source = it->second->source,
+                                        .parse_time = Clock::now() - start, .unread = true});
+            } else if (auto parsed = ParseFile(filepath, category)) {
+                result.files.push_back(std::move(*parsed));
+            }
+        }
+
+        result.finished = Clock::now();
+        return result;
+    }
+
+    // Large files are split so one giant list doesn't leave the other workers idle
+    constexpr std::uint32_t CHUNK_ENTRIES = 4096;
+
+    // A contiguous run of entries (and so a byte range) of one file
+    struct Chunk {
+        std::size_t file = 0;
+        std::uint32_t first_entry = 0;
+        std::uint32_t last_entry = 0;  // exclusive
+        std::vector<FormListParser::Token> tokens;
+        std::vector<FormID> forms;
+        std::vector<std::uint32_t> unresolved;  // entry indices
+        Clock::duration resolve_time{};
+    };
+
+    // Where a plugin sits in the load order; looked up once per name for the whole session. Guarded by g_reloadMutex.
+    struct PluginSlot {
+        bool loaded = false;
+        bool light = false;
+        std::uint32_t index = 0;
+    };
+    std::unordered_map<std::string, PluginSlot> g_pluginSlots;
+
+    std::string ToLower(const std::string_view a_str) {
+        std::string lower(a_str);
+        std::ranges::transform(lower, lower.begin(), [](const unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+        return lower;
+    }
+
+    const PluginSlot& GetPluginSlotLocked(const std::string_view a_plugin) {
+        auto [it, inserted] = g_pluginSlots.try_emplace(ToLower(a_plugin));
+        if (inserted) {
+            if (const auto file = RE::TESDataHandler::GetSingleton()->LookupModByName(a_plugin)) {
+                if (file->IsLight() && file->smallFileCompileIndex != 0xFFFF) {
+                    it->second = {.loaded = true, .light = true, .index = file->smallFileCompileIndex};
+                } else if (!file->IsLight() && file->compileIndex != 0xFF) {
+                    it->second = {.loaded = true, .light = false, .index = file->compileIndex};
+                }
+            }
+        }
+        return it->second;
+    }
+
+    FormID ToGlobalFormID(const PluginSlot& a_slot, const std::uint32_t a_localID) {
+        if (!a_slot.loaded) return 0;
+        return a_slot.light ? 0xFE000000u | (a_slot.index << 12) | (a_localID & 0xFFFu)
+                            : (a_slot.index << 24) | (a_localID & 0xFFFFFFu);
+    }
+
+    void ReportUnresolved(const ParsedFile& a_file, const std::vector<std::uint32_t>& a_unresolved) {
+        constexpr std::size_t MAX_LISTED = 5;
+        std::string listed;
+        for (std::size_t i = 0; i < std::min(a_unresolved.size(), MAX_LISTED); ++i) {
+            const auto& entry = a_file.entries[a_unresolved[i]];
+            listed += std::format("{}line {}: {}", i ? ", " : "", entry.line_number, a_file.GetEntry(entry));
+        }
+        logger::warn("{} of {} entries in {} did not resolve ({}{})", a_unresolved.size(), a_file.entries.size(),
+                     a_file.filepath.string(), listed, a_unresolved.size() > MAX_LISTED ? ", ..." : "");
+    }
+
+    struct ResolvedFile {
+        std::vector<FormID> forms;
+        std::vector<std::string> rules;  // syntax-checked, evaluated later by RunRulesLocked
+    };
+
+    // Resolves a batch of files into sorted, deduplicated FormID lists. Caller holds g_reloadMutex.
+    //  1. every chunk splits its entries into tokens (plugin + local id, full id, editor id) on the task pool
+    //  2. plugin names and editor ids are gathered across all files and each distinct one is looked up once
+    //  3. chunks turn their tokens into FormIDs from those tables on the task pool
+    // Every chunk writes only to its own slot and each file is merged from its chunks afterwards, so nothing is locked.
+    std::vector<ResolvedFile> ResolveFiles(const std::vector<const ParsedFile*>& a_files) {
+        std::vector<ResolvedFile> results(a_files.size());
+        if (a_files.empty()) {
+            return results;
+        }
+        const auto start = Clock::now();
+
+        std::vector<Chunk> chunks;
+        std::size_t total_entries = 0;
+        for (std::size_t file = 0; file < a_files.size(); ++file) {
+            const auto entry_count = static_cast<std::uint32_t>(a_files[file]->entries.size());
+            total_entries += entry_count;
+            for (std::uint32_t first = 0; first < entry_count; first += CHUNK_ENTRIES) {
+                chunks.push_back({.file = file, .first_entry = first, .last_entry = std::min(first + CHUNK_ENTRIES, entry_count)});
+            }
+        }
+
+        auto& pool = TaskPool::GetSingleton();
+        pool.ParallelFor(chunks.size(), [&](const std::size_t a_index) {
+            const auto tokenize_start = Clock::now();
+            auto& chunk = chunks[a_index];
+            const auto& file = *a_files[chunk.file];
+            chunk.tokens.reserve(chunk.last_entry - chunk.first_entry);
+            for (auto i = chunk.first_entry; i < chunk.last_entry; ++i) {
+                chunk.tokens.push_back(FormListParser::ParseToken(file.GetEntry(file.entries[i])));
+            }
+            chunk.resolve_time += Clock::now() - tokenize_start;
+        });
+
+        // one lookup per distinct plugin and editor id, however many entries repeat them
+        std::unordered_map<std::string_view, const PluginSlot*> plugins;
+        std::unordered_map<std::string_view, FormID> editor_ids;
+        std::vector<FormListParser::RuleCondition> conditions;
+        for (const auto& chunk : chunks) {
+            for (std::uint32_t i = 0; i < chunk.tokens.size(); ++i) {
+                const auto& token = chunk.tokens[i];
+                if (token.kind == FormListParser::Token::Kind::kPluginLocal && !plugins.contains(token.name)) {
+                    plugins.emplace(token.name, &GetPluginSlotLocked(token.name));
+                } else if (token.kind == FormListParser::Token::Kind::kEditorID) {
+                    editor_ids.try_emplace(token.name, 0);
+                } else if (token.kind == FormListParser::Token::Kind::kRule) {
+                    std::string_view syntax_error;
+                    if (FormListParser::ParseRule(token.name, conditions, syntax_error)) {
+                        results[chunk.file].rules.emplace_back(token.name);
+                    } else {
+                        logger::warn("Rule at line {} in file {} ignored: {}", a_files[chunk.file]->entries[chunk.first_entry + i].line_number,
+                                     a_files[chunk.file]->filepath.string(), syntax_error);
+                    }
+                }
+            }
+        }
+        {
+            std::vector<std::pair<const std::string_view, FormID>*> pending;
+            pending.reserve(editor_ids.size());
+            for (auto& editor_id : editor_ids) {
+                pending.push_back(&editor_id);
+            }
+            pool.ParallelFor(pending.size(), [&](const std::size_t a_index) {
+                auto& [name, form_id] = *pending[a_index];
+                thread_local std::string token;
+                token.assign(name);
+                if (const auto form = RE::TESForm::LookupByEditorID(token)) {
+                    form_id = form->GetFormID();
+                } else {
+                    // editor ids the game does not keep in memory
+                    form_id = FormReader::GetFormEditorIDFromString(token);
+                }
+            });
+        }
+
+        pool.ParallelFor(chunks.size(), [&](const std::size_t a_index) {
+            const auto resolve_start = Clock::now();
+            auto& chunk = chunks[a_index];
+            const auto& file = *a_files[chunk.file];
+            chunk.forms.reserve(chunk.tokens.size());
+
+            thread_local std::string fallback;
+            for (std::uint32_t i = 0; i < chunk.tokens.size(); ++i) {
+                const auto& token = chunk.tokens[i];
+                FormID form_id = 0;
+                switch (token.kind) {
+                    case FormListParser::Token::Kind::kPluginLocal:
+                        form_id = ToGlobalFormID(*plugins.at(token.name), token.id);
+                        break;
+                    case FormListParser::Token::Kind::kFormID:
+                        form_id = token.id;
+                        break;
+                    case FormListParser::Token::Kind::kEditorID:
+                        form_id = editor_ids.at(token.name);
+                        break;
+                    case FormListParser::Token::Kind::kRule:
+                        // matched against all objects by RunRulesLocked; syntax errors were reported above
+                        continue;
+                    case FormListParser::Token::Kind::kUnknown:
+                        fallback.assign(file.GetEntry(file.entries[chunk.first_entry + i]));
+                        form_id = FormReader::GetFormEditorIDFromString(fallback);
+                        break;
+                }
+                // plugin-relative and full ids are only numbers until the form is known to exist
+                if (form_id != 0 && token.kind != FormListParser::Token::Kind::kEditorID && !RE::TESForm::LookupByID(form_id)) {
+                    form_id = 0;
+                }
+
+                if (form_id != 0) {
+                    chunk.forms.push_back(form_id);
+                } else {
+                    chunk.unresolved.push_back(chunk.first_entry + i);
+                }
+            }
+            chunk.resolve_time += Clock::now() - resolve_start;
+        });
+
+        // chunks are in file order, so each file's pieces are adjacent
+        std::vector<Clock::duration> resolve_times(a_files.size());
+        std::vector<std::vector<std::uint32_t>> unresolved(a_files.size());
+        for (auto& chunk : chunks) {
+            auto& forms = results[chunk.file].forms;
+            forms.insert(forms.end(), chunk.forms.begin(), chunk.forms.end());
+            unresolved[chunk.file].insert(unresolved[chunk.file].end(), chunk.unresolved.begin(), chunk.unresolved.end());
+            resolve_times[chunk.file] += chunk.resolve_time;
+        }
+
+        for (std::size_t file = 0; file < a_files.size(); ++file) {
+            const auto& parsed = *a_files[file];
+            auto& forms = results[file].forms;
+            std::ranges::sort(forms);
+            const auto [first, last] = std::ranges::unique(forms);
+            forms.erase(first, last);
+
+            if (!unresolved[file].empty()) {
+                ReportUnresolved(parsed, unresolved[file]);
+            }
+            if (!forms.empty()) {
+                logger::info("Loaded {} forms from {}", forms.size(), parsed.filepath.string());
+            }
+            Metrics::RecordFileLoad(parsed.source.path, category_mappings[parsed.category].category_folder, parsed.parse_time,
+                                    resolve_times[file], parsed.entries.size(), forms.size(), false);
+        }
+
+        logger::info("Resolved {} entries ({} plugins, {} editor ids) from {} files in {} chunks on {} threads in {:.2f} ms",
+                     total_entries, plugins.size(), editor_ids.size(), a_files.size(), chunks.size(), pool.GetConcurrency(),
+                     ToMilliseconds(Clock::now() - start));
+        return results;
+    }
+
+    void StoreResolved(const ParsedFile& a_file, ResolvedFile a_resolved) {
+        g_resolvedFiles.insert_or_assign(a_file.source.path,
+                                         FormListCache::CachedFile{.source = a_file.source,
+                                                                   .category = std::string(category_mappings[a_file.category].category_folder),
+                                                                   .entry_count = static_cast<std::uint32_t>(a_file.entries.size()),
+                                                                   .forms = std::move(a_resolved.forms),
+                                                                   .rules = std::move(a_resolved.rules)});
+    }
+
+    // Evaluates the rules of every file over every inventory object and swaps in what they matched. The pool's
+    // threads read the forms, so this runs only on the main thread (at kDataLoaded or from a task), where nothing
+    // changes them meanwhile.
+    std::shared_ptr<const RuleMatches> RunRules(const ResolvedFiles& a_files) {
+        const auto start = Clock::now();
+        auto rule_matches = std::make_shared<RuleMatches>();
+
+        RuleProgram rules;
+        std::vector<const std::string*> tags;
+        std::vector<FormListParser::RuleCondition> conditions;
+        for (const auto& [path, file] : a_files) {
+            for (const auto& rule : file.rules) {
+                std::string_view syntax_error;
+                std::string error;
+                if (!FormListParser::ParseRule(rule, conditions, syntax_error)) {
+                    error = syntax_error;
+                } else if (rules.AddRule(conditions, tags.size(), error)) {
+                    continue;
+                }
+                logger::warn("Rule '{}' in file {} ignored: {}", rule, path, error);
+            }
+            tags.push_back(&path);
+        }
+        if (!rules.empty()) {
+            auto matches = rules.Run(tags.size());
+            std::size_t matched = 0;
+            for (std::size_t tag = 0; tag < tags.size(); ++tag) {
+                if (matches[tag].empty()) continue;
+                matched += matches[tag].size();
+                rule_matches->emplace(*tags[tag], std::move(matches[tag]));
+            }
+            logger::info("Applied {} rules to all inventory objects in {:.2f} ms, {} matches", rules.size(),
+                         ToMilliseconds(Clock::now() - start), matched);
+        }
+
+        std::shared_ptr<const RuleMatches> published = std::move(rule_matches);
+        g_ruleMatches.store(published);
+        return published;
+    }
+
+    // Builds a snapshot from a_files and what their rules matched, and publishes it
+    void PublishResolved(const ResolvedFiles& a_files, const RuleMatches& a_ruleMatches) {
+        std::array<std::vector<FormID>, category_mappings.size()> collected;
+        for (const auto& [path, file] : a_files) {
+            const auto mapping = std::ranges::find(category_mappings, file.category, &CategoryMapping::category_folder);
+            if (mapping != category_mappings.end()) {
+                auto& target = collected[std::distance(category_mappings.begin(), mapping)];
+                target.insert(target.end(), file.forms.begin(), file.forms.end());
+                if (const auto matches = a_ruleMatches.find(path); matches != a_ruleMatches.end()) {
+                    target.insert(target.end(), matches->second.begin(), matches->second.end());
+                }
+            }
+        }
+
+        // the lists never change after this point, so they are frozen into sorted arrays
+        auto snapshot = std::make_shared<FormLists::Snapshot>();
+        std::size_t frozen_bytes = 0;
+        std::size_t node_set_bytes = 0;
+        for (std::size_t i = 0; i < category_mappings.size(); ++i) {
+            const auto& [category_folder, target_list] = category_mappings[i];
+            auto& target = (*snapshot).*target_list;
+            target = FrozenFormSet(std::move(collected[i]));
+            frozen_bytes += target.memory_usage();
+            // what an unordered_set would hold: a node (next pointer + value, padded) plus a bucket pointer per entry
+            node_set_bytes += target.size() * (2 * sizeof(void*) + sizeof(void*));
+            logger::info("Total loaded for category '{}': {}", category_folder, target.size());
+        }
+        logger::info("Form lists take {} KiB frozen (about {} KiB as hash sets)", frozen_bytes / 1024, node_set_bytes / 1024);
+
+        FormLists::BuildSnapshotIndex(*snapshot);
+        FormLists::PublishSnapshot(std::move(snapshot));
+    }
+
+    // Main thread task: runs the rules over the latest copy a reload left and publishes the result, without the
+    // reload lock, so a reload in progress never stalls the frame
+    void RunPendingRules() {
+        for (;;) {
+            if (const auto files = g_pendingRuleRun.exchange(nullptr)) {
+                PublishResolved(*files, *RunRules(*files));
+            }
+            g_ruleRunQueued.store(false);
+            // a reload that left another copy meanwhile saw this task still queued and did not queue one
+            if (!g_pendingRuleRun.load() || g_ruleRunQueued.exchange(true)) return;
+        }
+    }
+
+    // Called from a reload once g_resolvedFiles changed
+    void PublishReloadedLocked(const bool a_rulesChanged) {
+        // while a rule run is queued or finishing it publishes after this reload would, with matches this reload
+        // cannot see yet, so it is handed this copy instead
+        if (a_rulesChanged || g_ruleRunQueued.load() || g_pendingRuleRun.load()) {
+            g_pendingRuleRun.store(std::make_shared<const ResolvedFiles>(g_resolvedFiles));
+            if (!g_ruleRunQueued.exchange(true)) {
+                SKSE::GetTaskInterface()->AddTask(RunPendingRules);
+            }
+            return;
+        }
+        static const RuleMatches no_matches;
+        const auto rule_matches = g_ruleMatches.load();
+        PublishResolved(g_resolvedFiles, rule_matches ? *rule_matches : no_matches);
+    }
+
+    void SaveCacheLocked() {
+        std::vector<FormListCache::CachedFile> cached_files;
+        cached_files.reserve(g_resolvedFiles.size());
+        for (const auto& file : g_resolvedFiles | std::views::values) {
+            cached_files.push_back(file);
+        }
+        FormListCache::Save(std::filesystem::path(TXT_BASE_FOLDER) / CACHE_FILE_NAME, g_loadOrderHash, cached_files);
+    }
+}
+
+void FormLists::StartLoadingFormLists() {
+    if (g_parseJob.valid()) return;
+    logger::info("Parsing form lists from TXT files in {} in the background", TXT_BASE_FOLDER);
+    g_parseJob = std::async(std::launch::async, ParseAllFormLists);
+}
+
+void FormLists::GetAllFormLists() {
+    const auto join_started = Clock::now();
+    if (!g_parseJob.valid()) {
+        StartLoadingFormLists();
+    }
+    auto parsed = g_parseJob.get();
+    const auto join_finished = Clock::now();
+
+    const auto parse_time = parsed.finished - parsed.started;
+    const auto wait_time = join_finished - join_started;
+    logger::info("Parsed {} TXT files ({} unchanged since the cache, not read) in {:.2f} ms; waited {:.2f} ms at kDataLoaded, "
+                 "{:.2f} ms overlapped with game data load",
+                 parsed.files.size(), std::ranges::count(parsed.files, true, &ParsedFile::unread), ToMilliseconds(parse_time),
+                 ToMilliseconds(wait_time),
+                 ToMilliseconds(std::max(parse_time - wait_time, Clock::duration::zero())));
+
+    std::lock_guard lock(g_reloadMutex);
+    g_loadOrderHash = FormListCache::GetLoadOrderFingerprint();
+    g_pluginSlots.clear();
+    g_resolvedFiles.clear();
+
+    if (parsed.files.empty()) {
+        logger::info("No TXT files found for any category.");
+    }
+
+    // ---- reuse cached results for every file that did not change ----
+    std::map<std::string, FormListCache::CachedFile> cached;
+    if (parsed.cache && parsed.cache->load_order_hash != g_loadOrderHash) {
+        logger::info("Load order changed since the form list cache was written, rebuilding");
+    } else if (parsed.cache) {
+        for (auto& file : parsed.cache->files) {
+            auto path = file.source.path;
+            cached.emplace(std::move(path), std::move(file));
+        }
+    }
+
+    std::vector<const ParsedFile*> to_resolve;
+    for (auto& file : parsed.files) {
+        const auto it = cached.find(file.source.path);
+        if (it != cached.end() && it->second.source == file.source &&
+            it->second.category == category_mappings[file.category].category_folder) {
+            Metrics::RecordFileLoad(file.source.path, it->second.category, file.parse_time, Clock::duration::zero(),
+                                    it->second.entry_count, it->second.forms.size(), true);
+            g_resolvedFiles.insert_or_assign(file.source.path, std::move(it->second));
+            continue;
+        }
+        if (file.unread) {
+            // skipped against a cache that turned out to be for another load order
+            auto reparsed = ParseFile(file.filepath, file.category);
+            if (!reparsed) continue;
+            file = std::move(*reparsed);
+        }
+        to_resolve.push_back(&file);
+    }
+    logger::info("Reusing cached forms for {} of {} TXT files", parsed.files.size() - to_resolve.size(), parsed.files.size());
+
+    auto results = ResolveFiles(to_resolve);
+    for (std::size_t i = 0; i < to_resolve.size(); ++i) {
+        StoreResolved(*to_resolve[i], std::move(results[i]));
+    }
+
+    // rules of cached files as well: their matches depend on the game data, which the cache does not describe
+    PublishResolved(g_resolvedFiles, *RunRules(g_resolvedFiles));
+    SaveCacheLocked();
+    logger::info("Form lists ready {:.2f} ms after kDataLoaded", ToMilliseconds(Clock::now() - join_started));
+}
+
+bool FormLists::ReloadFormLists(const bool a_force) {
+    std::lock_guard lock(g_reloadMutex);
+
+    bool changed = false;
+    bool touched = false;
+    bool rules_changed = false;
+    std::set<std::string> seen;
+    std::vector<ParsedFile> parsed_files;
+
+    for (const auto& [filepath, category] : ListCategoryFiles(false)) {
+        const auto key = filepath.generic_string();
+        seen.insert(key);
+
+        const auto existing = g_resolvedFiles.find(key);
+        const bool known = existing != g_resolvedFiles.end() &&
+                           existing->second.category == category_mappings[category].category_folder;
+        if (!a_force && known && IsUnchangedOnDisk(filepath, existing->second.source)) {
+            continue;
+        }
+
+        auto parsed = ParseFile(filepath, category);
+        if (!parsed) {
+            // probably still being written; keep the previous contents and retry on the next pass
+            continue;
+        }
+        if (!a_force && known && existing->second.source.content_hash == parsed->source.content_hash) {
+            existing->second.source = parsed->source;  // touched but not edited
+            touched = true;
+            continue;
+        }
+        parsed_files.push_back(std::move(*parsed));
+    }
+
+    for (auto it = g_resolvedFiles.begin(); it != g_resolvedFiles.end();) {
+        if (!seen.contains(it->first)) {
+            logger::info("TXT file removed: {}", it->first);
+            rules_changed |= !it->second.rules.empty();
+            it = g_resolvedFiles.erase(it);
+            changed = true;
+        } else {
+            ++it;
+        }
+    }
+
+    std::vector<const ParsedFile*> to_resolve;
+    for (const auto& file : parsed_files) {
+        logger::info("Reloading TXT file {}", file.filepath.string());
+        to_resolve.push_back(&file);
+    }
+    auto results = ResolveFiles(to_resolve);
+    for (std::size_t i = 0; i < to_resolve.size(); ++i) {
+        const auto previous = g_resolvedFiles.find(to_resolve[i]->source.path);
+        rules_changed |= !results[i].rules.empty() || (previous != g_resolvedFiles.end() && !previous->second.rules.empty());
+        StoreResolved(*to_resolve[i], std::move(results[i]));
+        changed = true;
+    }
+
+    if (changed) {
+        PublishReloadedLocked(rules_changed);
+    }
+    if (changed || touched) {
+        SaveCacheLocked();
+    }
+    return changed;
+}
+
+namespace {
+    std::atomic<bool> g_watcherRunning{false};
+
+    void WatchFormLists() {
+        for (;;) {
+            while (Settings::watch_form_lists.load()) {
+                std::this_thread::sleep_for(WATCH_INTERVAL);
+                if (!Settings::watch_form_lists.load()) break;
+                FormLists::ReloadFormLists(false);
+            }
+            g_watcherRunning.store(false);
+            // turned back on while this thread was on its way out, and no other watcher was started
+            if (!Settings::watch_form_lists.load() || g_watcherRunning.exchange(true)) return;
+        }
+    }
+}
+
+void FormLists::StartWatchingFormLists() {
+    if (!Settings::watch_form_lists.load() || g_watcherRunning.exchange(true)) return;
+    // detached on purpose: joining in a static destructor would run under the loader lock at exit
+    std::thread(WatchFormLists).detach();
+}
@@ -0,0 +1,270 @@
+#include "Metrics.h"
+#include <bit>
+
+namespace {
+    constexpr std::array<std::string_view, Metrics::kTransferSlotCount> slot_names = {
+        "Weapon",   "Ammo",       "ArmorStrict", "Jewelry",    "Shield",    "Clothing",      "Poison",
+        "Potion",   "ScrollItem", "Food",        "RawFood",    "CookedFood", "Sweets",       "Drinks",
+        "Ingredient", "BookAll",  "BookSpell",   "BookSkill",  "BookRecipe", "BookStrict",   "Key",
+        "MiscAll",  "SoulGem",    "Ores",        "Gems",       "LeatherNPelts", "BuildingMaterials", "Multi"};
+
+    constexpr std::array<std::string_view, Metrics::kTransferPhaseCount> phase_names = {
+        "filter", "plan wait", "plan", "ui enqueue", "commit wait", "apply", "apply wait", "total"};
+
+    struct TransferSlot {
+        std::array<Metrics::LatencyHistogram, Metrics::kTransferPhaseCount> phases;
+        std::atomic<std::uint64_t> entries_scanned{0};
+        std::atomic<std::uint64_t> items_moved{0};
+    };
+
+    std::array<TransferSlot, Metrics::kTransferSlotCount> g_transfers;
+
+    // indexed by RequestOutcome
+    std::array<std::atomic<std::uint64_t>, 3> g_requests{};
+
+#ifndef NDEBUG
+    // operator new calls on threads inside a TransferScope
+    std::atomic<std::uint64_t> g_transferAllocations{0};
+    thread_local std::uint32_t t_transferScopes = 0;
+    // what the previous report showed, so the next one can tell what changed since; reports may be built concurrently
+    std::atomic<std::uint64_t> g_reportedAllocations{0};
+    std::atomic<std::uint64_t> g_reportedTransfers{0};
+#endif
+
+    struct FileLoadRecord {
+        std::string category;
+        Metrics::Clock::duration parse{};
+        Metrics::Clock::duration resolve{};
+        std::size_t entries = 0;
+        std::size_t forms = 0;
+        bool cached = false;
+    };
+
+    std::mutex g_fileLoadMutex;
+    std::map<std::string, FileLoadRecord, std::less<>> g_fileLoads;
+
+    double ToMilliseconds(const Metrics::Clock::duration a_duration) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(a_duration).count() / 1000.0;
+    }
+}
+
+std::size_t Metrics::LatencyHistogram::BucketOf(const std::uint64_t a_micros) noexcept {
+    if (a_micros < kSubBuckets) {
+        return static_cast<std::size_t>(a_micros);
+    }
+    const auto exponent = static_cast<std::size_t>(std::bit_width(a_micros) - 1);  // >= 2
+    const auto sub = static_cast<std::size_t>((a_micros >> (exponent - 2)) & (kSubBuckets - 1));
+    return std::min((exponent - 1) * kSubBuckets + sub, kBuckets - 1);
+}
+
+double Metrics::LatencyHistogram::BucketUpperBound(const std::size_t a_bucket) noexcept {
+    if (a_bucket < kSubBuckets) {
+        return static_cast<double>(a_bucket + 1);
+    }
+    const auto exponent = a_bucket / kSubBuckets + 1;
+    const auto sub = a_bucket % kSubBuckets;
+    return std::ldexp(1.0 + static_cast<double>(sub + 1) / kSubBuckets, static_cast<int>(exponent));
+}
+
+void Metrics::LatencyHistogram::Record(const Clock::duration a_duration) noexcept {
+    const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(a_duration).count();
+    _buckets[BucketOf(micros > 0 ? static_cast<std::uint64_t>(micros) : 0)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+}
+
+double Metrics::LatencyHistogram::Percentile(const double a_percentile) const noexcept {
+    std::array<std::uint64_t, kBuckets> counts{};
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+        counts[i] = _buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0.0;
+    }
+
+    const auto rank = static_cast<std::uint64_t>(std::ceil(std::clamp(a_percentile, 0.0, 100.0) / 100.0 * static_cast<double>(total)));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+        seen += counts[i];
+        if (seen >= std::max<std::uint64_t>(rank, 1)) {
+            return BucketUpperBound(i);
+        }
+    }
+    return BucketUpperBound(kBuckets - 1);
+}
+
+void Metrics::TransferTimer::EndPhase(const TransferPhase a_phase) noexcept {
+    const auto now = Clock::now();
+    _phases[static_cast<std::size_t>(a_phase)] += now - _last;
+    _last = now;
+}
+
+void Metrics::TransferTimer::AddTime(const TransferPhase a_phase, const Clock::duration a_duration) noexcept {
+    _phases[static_cast<std::size_t>(a_phase)] += a_duration;
+}
+
+void Metrics::TransferTimer::SetCounts(const std::size_t a_scanned, const std::size_t a_moved) noexcept {
+    _scanned = a_scanned;
+    _moved = a_moved;
+}
+
+void Metrics::TransferTimer::Finish() noexcept {
+    const auto now = Clock::now();
+    _phases[static_cast<std::size_t>(TransferPhase::kTotal)] = now - _start;
+
+    Clock::duration accounted{};
+    for (std::size_t i = 0; i < static_cast<std::size_t>(TransferPhase::kTotal); ++i) {
+        accounted += _phases[i];
+    }
+    _phases[static_cast<std::size_t>(TransferPhase::kApplyWait)] += std::max(now - _start - accounted, Clock::duration::zero());
+
+    auto& slot = g_transfers[std::min(_slot, kTransferSlotCount - 1)];
+    for (std::size_t i = 0; i < kTransferPhaseCount; ++i) {
+        slot.phases[i].Record(_phases[i]);
+    }
+    slot.entries_scanned.fetch_add(_scanned, std::memory_order_relaxed);
+    slot.items_moved.fetch_add(_moved, std::memory_order_relaxed);
+}
+
+void Metrics::RecordTransferRequest(const RequestOutcome a_outcome) noexcept {
+    g_requests[static_cast<std::size_t>(a_outcome)].fetch_add(1, std::memory_order_relaxed);
+}
+
+Metrics::TransferScope::TransferScope() noexcept {
+#ifndef NDEBUG
+    ++t_transferScopes;
+#endif
+}
+
+Metrics::TransferScope::~TransferScope() {
+#ifndef NDEBUG
+    --t_transferScopes;
+#endif
+}
+
+void Metrics::RecordFileLoad(const std::string_view a_path, const std::string_view a_category, const Clock::duration a_parse,
+                             const Clock::duration a_resolve, const std::size_t a_entries, const std::size_t a_forms,
+                             const bool a_cached) {
+    std::lock_guard lock(g_fileLoadMutex);
+    g_fileLoads.insert_or_assign(std::string(a_path), FileLoadRecord{.category = std::string(a_category),
+                                                                     .parse = a_parse,
+                                                                     .resolve = a_resolve,
+                                                                     .entries = a_entries,
+                                                                     .forms = a_forms,
+                                                                     .cached = a_cached});
+}
+
+double Metrics::GetTransferPercentile(const std::size_t a_slot, const double a_percentile) {
+    if (a_slot >= kTransferSlotCount) {
+        return 0.0;
+    }
+    return g_transfers[a_slot].phases[static_cast<std::size_t>(TransferPhase::kTotal)].Percentile(a_percentile) / 1000.0;
+}
+
+std::string Metrics::BuildReport() {
+    std::string report = std::format("Transfer requests: {} run, {} merged into a pending one, {} dropped as no-ops\n",
+                                     g_requests[static_cast<std::size_t>(RequestOutcome::kRun)].load(std::memory_order_relaxed),
+                                     g_requests[static_cast<std::size_t>(RequestOutcome::kMerged)].load(std::memory_order_relaxed),
+                                     g_requests[static_cast<std::size_t>(RequestOutcome::kDropped)].load(std::memory_order_relaxed));
+#ifndef NDEBUG
+    {
+        // every operator new of the plugin inside a TransferScope; the game's heap and SKSE's own task queue are not
+        // counted. Flat once the scratch pools are warm and the open container is indexed; a count that keeps rising
+        // means something on the transfer path allocates per transfer.
+        std::uint64_t transfers = 0;
+        for (const auto& slot : g_transfers) {
+            transfers += slot.phases[static_cast<std::size_t>(TransferPhase::kTotal)].Count();
+        }
+        const auto allocations = g_transferAllocations.load(std::memory_order_relaxed);
+        const auto reported_allocations = g_reportedAllocations.exchange(allocations, std::memory_order_relaxed);
+        const auto reported_transfers = g_reportedTransfers.exchange(transfers, std::memory_order_relaxed);
+        report += std::format("Transfer path heap allocations: {} ({} over the {} transfers since the last report)\n", allocations,
+                              allocations - std::min(allocations, reported_allocations), transfers - std::min(transfers, reported_transfers));
+    }
+#endif
+    report += "Transfers (latency in us, p50/p95/p99):\n";
+    for (std::size_t i = 0; i < kTransferSlotCount; ++i) {
+        const auto& slot = g_transfers[i];
+        const auto count = slot.phases[static_cast<std::size_t>(TransferPhase::kTotal)].Count();
+        if (count == 0) {
+            continue;
+        }
+        report += std::format("  {}: {} transfers, {} entries scanned, {} items moved\n", slot_names[i], count,
+                              slot.entries_scanned.load(std::memory_order_relaxed),
+                              slot.items_moved.load(std::memory_order_relaxed));
+        for (std::size_t phase = 0; phase < kTransferPhaseCount; ++phase) {
+            const auto& histogram = slot.phases[phase];
+            report += std::format("    {:<12} {:>9.0f} {:>9.0f} {:>9.0f}\n", phase_names[phase], histogram.Percentile(50),
+                                  histogram.Percentile(95), histogram.Percentile(99));
+        }
+    }
+
+    std::lock_guard lock(g_fileLoadMutex);
+    report += "Form list files (ms):\n";
+    std::map<std::string_view, FileLoadRecord> categories;
+    for (const auto& [path, record] : g_fileLoads) {
+        report += std::format("  {}: parse {:.2f}, resolve {:.2f}, {} entries -> {} forms{}\n", path,
+                              ToMilliseconds(record.parse), ToMilliseconds(record.resolve), record.entries, record.forms,
+                              record.cached ? " (cached)" : "");
+        auto& total = categories[record.category];
+        total.parse += record.parse;
+        total.resolve += record.resolve;
+        total.entries += record.entries;
+        total.forms += record.forms;
+    }
+    report += "Form list categories (ms):\n";
+    for (const auto& [category, total] : categories) {
+        report += std::format("  {}: parse {:.2f}, resolve {:.2f}, {} entries -> {} forms\n", category,
+                              ToMilliseconds(total.parse), ToMilliseconds(total.resolve), total.entries, total.forms);
+    }
+    return report;
+}
+
+#ifndef NDEBUG
+// The plugin's global allocation functions, replaced to count allocations inside a TransferScope. The array and
+// nothrow forms forward to these by default.
+namespace {
+    void CountAllocation() noexcept {
+        if (t_transferScopes) g_transferAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void* operator new(const std::size_t a_size) {
+    CountAllocation();
+    if (const auto ptr = std::malloc(a_size ? a_size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(const std::size_t a_size, const std::align_val_t a_alignment) {
+    CountAllocation();
+    const auto alignment = static_cast<std::size_t>(a_alignment);
+#ifdef _MSC_VER
+    if (const auto ptr = _aligned_malloc(a_size ? a_size : 1, alignment)) return ptr;
+#else
+    // aligned_alloc wants a whole number of alignments
+    if (const auto ptr = std::aligned_alloc(alignment, std::max(alignment, (a_size + alignment - 1) / alignment * alignment))) return ptr;
+#endif
+    throw std::bad_alloc();
+}
+
+void operator delete(void* a_ptr) noexcept {
+    std::free(a_ptr);
+}
+
+void operator delete(void* a_ptr, std::size_t) noexcept {
+    std::free(a_ptr);
+}
+
+void operator delete(void* a_ptr, std::align_val_t) noexcept {
+#ifdef _MSC_VER
+    _aligned_free(a_ptr);
+#else
+    std::free(a_ptr);
+#endif
+}
+
+void operator delete(void* a_ptr, std::size_t, const std::align_val_t a_alignment) noexcept {
+    operator delete(a_ptr, a_alignment);
+}
+#endif
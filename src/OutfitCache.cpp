@@ -0,0 +1,68 @@
+#include "OutfitCache.h"
+
+namespace {
+    // Followers and looted NPCs; more than this and the whole cache starts over
+    constexpr std::size_t MAX_CACHED_ACTORS = 64;
+
+    // an item whose count has to be worked out again; entries are reset to this instead of erased, so items that
+    // move back and forth reuse their entry rather than allocating a new one each time
+    constexpr std::int32_t UNKNOWN_COUNT = -1;
+
+    struct ActorOutfitCounts {
+        FormID outfit = 0;
+        std::unordered_map<FormID, std::int32_t> counts;
+    };
+
+    std::mutex g_cacheMutex;
+    std::unordered_map<RefID, ActorOutfitCounts> g_cache;
+
+    std::int32_t CountOutfitCopies(const FormID a_outfit, const RE::InventoryEntryData* a_entry) {
+        std::int32_t outfit_count = 0;
+        if (const auto xLists = a_entry ? a_entry->extraLists : nullptr) {
+            for (const auto& xList : *xLists) {
+                if (!xList) continue;
+                if (const auto xOutfit = xList->GetByType<RE::ExtraOutfitItem>()) {
+                    if (a_outfit == xOutfit->id) {
+                        ++outfit_count;
+                    }
+                }
+            }
+        }
+        return outfit_count;
+    }
+}
+
+std::int32_t OutfitCache::GetOutfitCount(const RefID a_actor, const FormID a_outfit,
+                                         const RE::TESBoundObject* a_item, const RE::InventoryEntryData* a_entry) {
+    std::lock_guard lock(g_cacheMutex);
+
+    if (g_cache.size() >= MAX_CACHED_ACTORS && !g_cache.contains(a_actor)) {
+        g_cache.clear();
+    }
+
+    auto& actor_counts = g_cache[a_actor];
+    if (actor_counts.outfit != a_outfit) {
+        actor_counts.outfit = a_outfit;
+        actor_counts.counts.clear();
+    }
+
+    const auto it = actor_counts.counts.try_emplace(a_item->GetFormID(), UNKNOWN_COUNT).first;
+    if (it->second == UNKNOWN_COUNT) {
+        it->second = CountOutfitCopies(a_outfit, a_entry);
+    }
+    return it->second;
+}
+
+void OutfitCache::Invalidate(const RefID a_actor, const FormID a_item) {
+    std::lock_guard lock(g_cacheMutex);
+    if (const auto it = g_cache.find(a_actor); it != g_cache.end()) {
+        if (const auto count = it->second.counts.find(a_item); count != it->second.counts.end()) {
+            count->second = UNKNOWN_COUNT;
+        }
+    }
+}
+
+void OutfitCache::Clear() {
+    std::lock_guard lock(g_cacheMutex);
+    g_cache.clear();
+}
@@ -0,0 +1,161 @@
+#include "RuleProgram.h"
+#include "CLibUtilsQTR/FormReader.hpp"
+#include "Settings.h"
+#include "TaskPool.h"
+
+namespace {
+    struct TypeName {
+        std::string_view name;
+        RE::FormType type;
+    };
+
+    constexpr std::array type_names = {
+        TypeName{"Weapon", RE::FormType::Weapon},       TypeName{"Ammo", RE::FormType::Ammo},
+        TypeName{"Armor", RE::FormType::Armor},         TypeName{"Potion", RE::FormType::AlchemyItem},
+        TypeName{"Scroll", RE::FormType::Scroll},       TypeName{"Ingredient", RE::FormType::Ingredient},
+        TypeName{"Book", RE::FormType::Book},           TypeName{"Key", RE::FormType::KeyMaster},
+        TypeName{"Misc", RE::FormType::Misc},           TypeName{"SoulGem", RE::FormType::SoulGem},
+        TypeName{"Light", RE::FormType::Light},
+    };
+
+    const RE::BGSKeyword* LookupKeyword(const std::string_view a_name) {
+        const std::string name(a_name);
+        if (const auto keyword = RE::TESForm::LookupByEditorID<RE::BGSKeyword>(name)) {
+            return keyword;
+        }
+        // also accept the 0x123~Plugin.esp and full FormID forms
+        const auto form_id = FormReader::GetFormEditorIDFromString(name);
+        return form_id ? RE::TESForm::LookupByID<RE::BGSKeyword>(form_id) : nullptr;
+    }
+}
+
+bool RuleProgram::AddRule(const std::span<const FormListParser::RuleCondition> a_conditions, const std::size_t a_tag,
+                          std::string& a_error) {
+    using Field = FormListParser::RuleCondition::Field;
+    using Compare = FormListParser::RuleCondition::Compare;
+
+    const auto first = static_cast<std::uint32_t>(_code.size());
+    for (const auto& condition : a_conditions) {
+        Instruction instruction{.opcode = Opcode::kType, .negate = condition.negate, .type = RE::FormType::None, .keyword = nullptr, .bound = condition.number};
+        switch (condition.field) {
+            case Field::kType: {
+                const auto it = std::ranges::find(type_names, condition.text, &TypeName::name);
+                if (it == type_names.end()) {
+                    a_error = std::format("unknown type '{}'", condition.text);
+                    _code.resize(first);
+                    return false;
+                }
+                instruction.type = it->type;
+                break;
+            }
+            case Field::kKeyword:
+                instruction.opcode = Opcode::kKeyword;
+                instruction.keyword = LookupKeyword(condition.text);
+                if (!instruction.keyword) {
+                    a_error = std::format("unknown keyword '{}'", condition.text);
+                    _code.resize(first);
+                    return false;
+                }
+                break;
+            case Field::kWeight:
+            case Field::kValue: {
+                const bool weight = condition.field == Field::kWeight;
+                // <= and >= become the strict test with the result flipped: x <= b is !(x > b)
+                switch (condition.compare) {
+                    case Compare::kLess:
+                        instruction.opcode = weight ? Opcode::kWeightLess : Opcode::kValueLess;
+                        break;
+                    case Compare::kGreaterEqual:
+                        instruction.opcode = weight ? Opcode::kWeightLess : Opcode::kValueLess;
+                        instruction.negate = !instruction.negate;
+                        break;
+                    case Compare::kGreater:
+                        instruction.opcode = weight ? Opcode::kWeightGreater : Opcode::kValueGreater;
+                        break;
+                    case Compare::kLessEqual:
+                        instruction.opcode = weight ? Opcode::kWeightGreater : Opcode::kValueGreater;
+                        instruction.negate = !instruction.negate;
+                        break;
+                    case Compare::kEqual:
+                        instruction.opcode = weight ? Opcode::kWeightEqual : Opcode::kValueEqual;
+                        break;
+                }
+                break;
+            }
+        }
+        _code.push_back(instruction);
+    }
+
+    _rules.push_back({.first = first, .count = static_cast<std::uint32_t>(_code.size() - first), .tag = a_tag});
+    return true;
+}
+
+bool RuleProgram::Matches(const Rule& a_rule, RE::TESBoundObject* a_object) const {
+    const auto keywords = a_object->As<RE::BGSKeywordForm>();
+    for (auto pc = a_rule.first; pc < a_rule.first + a_rule.count; ++pc) {
+        const auto& [opcode, negate, type, keyword, bound] = _code[pc];
+        bool result = false;
+        switch (opcode) {
+            case Opcode::kType:
+                result = a_object->GetFormType() == type;
+                break;
+            case Opcode::kKeyword:
+                result = keywords && keywords->HasKeyword(keyword);
+                break;
+            case Opcode::kWeightLess:
+                result = a_object->GetWeight() < bound;
+                break;
+            case Opcode::kWeightGreater:
+                result = a_object->GetWeight() > bound;
+                break;
+            case Opcode::kWeightEqual:
+                result = a_object->GetWeight() == bound;
+                break;
+            case Opcode::kValueLess:
+                result = static_cast<float>(a_object->GetGoldValue()) < bound;
+                break;
+            case Opcode::kValueGreater:
+                result = static_cast<float>(a_object->GetGoldValue()) > bound;
+                break;
+            case Opcode::kValueEqual:
+                result = static_cast<float>(a_object->GetGoldValue()) == bound;
+                break;
+        }
+        if (result == negate) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<std::vector<FormID>> RuleProgram::Run(const std::size_t a_tagCount) const {
+    std::vector<std::vector<FormID>> matches(a_tagCount);
+    if (_rules.empty()) {
+        return matches;
+    }
+
+    const auto objects = FormLists::GetInventoryObjects();
+    constexpr std::size_t CHUNK_FORMS = 2048;
+    const auto chunk_count = (objects.size() + CHUNK_FORMS - 1) / CHUNK_FORMS;
+
+    // each chunk collects (tag, form) pairs on its own; merged afterwards
+    std::vector<std::vector<std::pair<std::size_t, FormID>>> chunks(chunk_count);
+    TaskPool::GetSingleton().ParallelFor(chunk_count, [&](const std::size_t a_index) {
+        const auto first = a_index * CHUNK_FORMS;
+        const auto last = std::min(first + CHUNK_FORMS, objects.size());
+        for (auto i = first; i < last; ++i) {
+            for (const auto& rule : _rules) {
+                if (rule.tag < a_tagCount && Matches(rule, objects[i])) {
+                    chunks[a_index].emplace_back(rule.tag, objects[i]->GetFormID());
+                }
+            }
+        }
+    });
+
+    for (const auto& chunk : chunks) {
+        for (const auto& [tag, form_id] : chunk) {
+            matches[tag].push_back(form_id);
+        }
+    }
+    return matches;
+}
@@ -1,153 +1,25 @@
 #include "Settings.h"
-#include "CLibUtilsQTR/FormReader.hpp"
-#include <thread>
+#include "TaskPool.h"
 #include <atomic>
 #include <cassert>
 
 namespace {
-    constexpr auto TXT_BASE_FOLDER = "Data/SKSE/Plugins/QuickItemTransfer";
-
-    std::mutex g_loadingMutex;
-
-    std::string trim(const std::string& str) {
-        const auto start = std::ranges::find_if(str, [](const unsigned char ch) {
-            return !std::isspace(ch);
-        });
-        const auto end = std::find_if(str.rbegin(), str.rend(), [](const unsigned char ch) {
-            return !std::isspace(ch);
-        }).base();
-        return (start < end) ? std::string(start, end) : std::string();
-    }
-
-    // Helper function to load FormIDs from a TXT file into a set
-    void LoadFormIDsFromFile(const std::filesystem::path& filepath, std::unordered_set<FormID>& target_set) {
-        if (!std::filesystem::exists(filepath)) {
-            logger::warn("TXT file not found: {}", filepath.string());
-            return;
-        }
-
-        std::ifstream file(filepath);
-        if (!file.is_open()) {
-            logger::error("Failed to open TXT file: {}", filepath.string());
-            return;
-        }
-
-        std::set<FormID> local_set;
-        std::string line;
-        int line_number = 0;
-
-        while (std::getline(file, line)) {
-            line_number++;
-
-            line = trim(line);
-
-            if (line.empty() || line[0] == '#' || line[0] == ';') {
-                continue;
-            }
+    // Type and keyword classification of every form loaded at kDataLoaded. TXT-backed bits are added per snapshot.
+    std::unordered_map<FormID, std::uint32_t> g_baseCategoryIndex;
 
-            const auto form_id = FormReader::GetFormEditorIDFromString(line);
-            if (form_id != 0) {
-                local_set.insert(form_id);
-            } else {
-                logger::warn("Invalid FormID at line {} in file {}: {}", line_number, filepath.string(), line);
-            }
-        }
-
-        if (!local_set.empty()) {
-            std::lock_guard lock(g_loadingMutex);
-            target_set.insert(local_set.begin(), local_set.end());
-            logger::info("Loaded {} forms from {}", local_set.size(), filepath.string());
-        }
-    }
+    std::atomic<std::shared_ptr<const FormLists::Snapshot>> g_snapshot;
 }
 
-void FormLists::GetAllFormLists() {
-    logger::info("Loading form lists from TXT files in {}", TXT_BASE_FOLDER);
-
-    std::filesystem::create_directories(TXT_BASE_FOLDER);
-
-    struct CategoryMapping {
-        std::string category_folder;
-        std::unordered_set<FormID>* target_set;
-    };
-
-    std::vector<CategoryMapping> mappings = {{"raw_food", &all_raw_food},
-                                             {"cooked_food", &all_cooked_food},
-                                             {"sweets", &all_sweets},
-                                             {"drinks", &all_drinks},
-                                             {"building_materials", &all_building_materials},
-                                             {"excludes", &excluded_forms}
-    };
-
-    // ---- collect all tasks first ----
-    struct LoadTask {
-        std::filesystem::path filepath;
-        std::unordered_set<FormID>* target_set;
-    };
-
-    std::vector<LoadTask> tasks;
-
-    for (const auto& [category_folder, target_set] : mappings) {
-        std::filesystem::path dirpath = std::filesystem::path(TXT_BASE_FOLDER) / category_folder;
-
-        if (!std::filesystem::exists(dirpath)) {
-            logger::warn("Category folder not found: {}", dirpath.string());
-            continue;
-        }
-
-        for (const auto& entry : std::filesystem::directory_iterator(dirpath)) {
-            if (!entry.is_regular_file()) {
-                continue;
-            }
-
-            const auto& path = entry.path();
-            if (!path.has_extension() || path.extension() != ".txt") {
-                continue;
-            }
-
-            tasks.push_back(LoadTask{path, target_set});
-        }
-    }
-
-    if (tasks.empty()) {
-        logger::info("No TXT files found for any category.");
-        return;
-    }
-
-    constexpr std::size_t MAX_WORKERS = 8;
-
-    const unsigned hw = std::thread::hardware_concurrency();
-    std::size_t worker_count = hw ? static_cast<std::size_t>(hw) : 2;
-    worker_count = std::min<std::size_t>(worker_count, MAX_WORKERS);
-    worker_count = std::min<std::size_t>(worker_count, tasks.size());
-
-    std::atomic<std::size_t> nextIndex{0};
-    std::vector<std::thread> workers;
-    workers.reserve(worker_count);
-
-    for (std::size_t i = 0; i < worker_count; ++i) {
-        workers.emplace_back([&]() {
-            for (;;) {
-                const std::size_t index = nextIndex.fetch_add(1, std::memory_order_relaxed);
-                if (index >= tasks.size()) {
-                    break;
-                }
-
-                auto& [filepath, target_set] = tasks[index];
-                LoadFormIDsFromFile(filepath, *target_set);
-            }
-        });
-    }
-
-    for (auto& t : workers) {
-        if (t.joinable()) {
-            t.join();
-        }
+std::shared_ptr<const FormLists::Snapshot> FormLists::GetSnapshot() {
+    if (auto snapshot = g_snapshot.load(std::memory_order_acquire)) {
+        return snapshot;
     }
+    static const auto empty = std::make_shared<const Snapshot>();
+    return empty;
+}
 
-    for (const auto& [category_folder, target_set] : mappings) {
-        logger::info("Total loaded for category '{}': {}", category_folder, target_set->size());
-    }
+void FormLists::PublishSnapshot(std::shared_ptr<const Snapshot> a_snapshot) {
+    g_snapshot.store(std::move(a_snapshot), std::memory_order_release);
 }
 
 void FormLists::LoadKeywords() {
@@ -162,18 +34,115 @@ void FormLists::LoadKeywords() {
         "Failed to load all vendor item keywords");
 }
 
-bool FormLists::IsByKW(const RE::TESBoundObject* a_item, std::unordered_set<FormID>& a_cache, const int a_kw_index) {
+bool FormLists::IsByKW(const RE::TESBoundObject* a_item, ConcurrentFormSet& a_cache, const int a_kw_index) {
     const auto formid = a_item->GetFormID();
     if (a_cache.contains(formid)) {
         return true;
     }
-    if (a_item->HasKeywordInArray({vendorItemKeywords[a_kw_index]}, false)) {
+    // a fresh insert is only visible after the next publication, so misses keep answering from the keyword.
+    // Asked of the keyword form directly: HasKeywordInArray would take a vector built for every probe.
+    const auto keyword = vendorItemKeywords[a_kw_index];
+    const auto keyword_form = a_item->As<RE::BGSKeywordForm>();
+    if (keyword && keyword_form && keyword_form->HasKeyword(keyword)) {
         a_cache.insert(formid);
         return true;
     }
     return false;
 }
 
+void FormLists::PublishKeywordCaches() {
+    for (const auto cache : {&all_gems, &all_ingot_ores, &all_leather_n_pelts, &raw_food_by_kw, &all_jewelry, &all_recipes}) {
+        cache->Publish();
+    }
+}
+
+std::uint32_t FormLists::ClassifyItem(RE::TESBoundObject* a_item, const Snapshot& a_lists) {
+    auto mask = ClassifyAllItemTypes(a_item, a_lists, std::make_index_sequence<kNone>{});
+    if (a_lists.excluded_forms.contains(a_item->GetFormID())) {
+        mask |= kExcludedBit;
+    }
+    return mask;
+}
+
+std::vector<RE::TESBoundObject*> FormLists::GetInventoryObjects() {
+    // every form type that can end up in an inventory and be matched by IsOfItemType
+    constexpr std::array form_types = {RE::FormType::Weapon, RE::FormType::Ammo,   RE::FormType::Armor,
+                                       RE::FormType::AlchemyItem, RE::FormType::Scroll, RE::FormType::Ingredient,
+                                       RE::FormType::Book,   RE::FormType::KeyMaster, RE::FormType::Misc,
+                                       RE::FormType::SoulGem, RE::FormType::Light};
+
+    std::vector<RE::TESBoundObject*> objects;
+    const auto data_handler = RE::TESDataHandler::GetSingleton();
+    for (const auto form_type : form_types) {
+        for (const auto form : data_handler->GetFormArray(form_type)) {
+            if (const auto bound_obj = form ? form->As<RE::TESBoundObject>() : nullptr) {
+                objects.push_back(bound_obj);
+            }
+        }
+    }
+    return objects;
+}
+
+void FormLists::BuildCategoryIndex() {
+    const auto start = std::chrono::steady_clock::now();
+
+    g_baseCategoryIndex.clear();
+
+    const auto objects = GetInventoryObjects();
+
+    // classifying against empty lists leaves only what the form itself says (type, keywords).
+    // The game is parked in the kDataLoaded handler, so the forms can be read from the pool's threads.
+    constexpr std::size_t CHUNK_FORMS = 2048;
+    const Snapshot no_lists;
+    std::vector<std::vector<std::pair<FormID, std::uint32_t>>> chunks((objects.size() + CHUNK_FORMS - 1) / CHUNK_FORMS);
+    TaskPool::GetSingleton().ParallelFor(chunks.size(), [&](const std::size_t a_index) {
+        const auto first = a_index * CHUNK_FORMS;
+        const auto last = std::min(first + CHUNK_FORMS, objects.size());
+        for (auto i = first; i < last; ++i) {
+            if (const auto mask = ClassifyItem(objects[i], no_lists)) {
+                chunks[a_index].emplace_back(objects[i]->GetFormID(), mask);
+            }
+        }
+    });
+
+    g_baseCategoryIndex.reserve(objects.size());
+    for (const auto& chunk : chunks) {
+        g_baseCategoryIndex.insert(chunk.begin(), chunk.end());
+    }
+
+    PublishKeywordCaches();
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    logger::info("Built category index for {} forms in {} ms", g_baseCategoryIndex.size(), elapsed.count());
+}
+
+void FormLists::BuildSnapshotIndex(Snapshot& a_snapshot) {
+    a_snapshot.category_index = g_baseCategoryIndex;
+
+    // TXT lists may name forms of any type; make sure they are indexed too
+    const std::array<std::pair<const FrozenFormSet*, std::uint32_t>, 6> listed = {{
+        {&a_snapshot.raw_food, ItemTypeBit(kRawFood)},
+        {&a_snapshot.cooked_food, ItemTypeBit(kCookedFood)},
+        {&a_snapshot.sweets, ItemTypeBit(kSweets)},
+        {&a_snapshot.drinks, ItemTypeBit(kDrinks)},
+        {&a_snapshot.building_materials, ItemTypeBit(kBuildingMaterials)},
+        {&a_snapshot.excluded_forms, kExcludedBit},
+    }};
+    for (const auto& [set, bit] : listed) {
+        for (const auto formid : *set) {
+            a_snapshot.category_index[formid] |= bit;
+        }
+    }
+}
+
+std::uint32_t FormLists::GetCategoryMask(RE::TESBoundObject* a_item, const Snapshot& a_lists) {
+    if (const auto it = a_lists.category_index.find(a_item->GetFormID()); it != a_lists.category_index.end()) {
+        return it->second;
+    }
+    // forms created at runtime (player-made potions, tempered copies, ...) were not around at kDataLoaded
+    return a_item->IsDynamicForm() ? ClassifyItem(a_item, a_lists) : 0;
+}
+
 bool FormLists::IsShield(RE::TESBoundObject* a_item) {
     if (const auto asd = a_item->As<RE::BGSBipedObjectForm>()) {
         return asd->IsShield();
@@ -0,0 +1,150 @@
+#include "StorageRoutes.h"
+#include "ContainerIndex.h"
+#include "InventoryVisitor.h"
+#include "Metrics.h"
+#include "TransferPlanner.h"
+#include "TransferQueue.h"
+#include <bit>
+
+namespace {
+    std::mutex g_routeMutex;
+    std::array<RE::ObjectRefHandle, kNone> g_routes{};
+
+    float GetRemainingCapacity(RE::TESObjectREFR* a_target) {
+        if (const auto actor = a_target->As<RE::Actor>()) {
+            if (const auto actor_val_owner = actor->AsActorValueOwner()) {
+                return actor_val_owner->GetActorValue(RE::ActorValue::kCarryWeight) -
+                       actor_val_owner->GetActorValue(RE::ActorValue::kInventoryWeight);
+            }
+        }
+        return FLT_MAX;
+    }
+
+    // Taken from the scratch pools and handed back at the end of each pass
+    struct Bucket {
+        RE::ObjectRefHandle container;
+        Scratch::Vector<TransferPlanner::Entry> entries;
+        Scratch::Vector<RE::TESBoundObject*> objects;
+    };
+}
+
+void StorageRoutes::SetRoute(const ItemTypes a_type, RE::TESObjectREFR* a_container) {
+    if (!IsItemType(a_type) || !a_container) return;
+    std::lock_guard lock(g_routeMutex);
+    g_routes[a_type] = a_container->GetHandle();
+}
+
+void StorageRoutes::ClearRoute(const ItemTypes a_type) {
+    if (!IsItemType(a_type)) return;
+    std::lock_guard lock(g_routeMutex);
+    g_routes[a_type] = {};
+}
+
+void StorageRoutes::ClearAllRoutes() {
+    std::lock_guard lock(g_routeMutex);
+    g_routes.fill({});
+}
+
+std::size_t StorageRoutes::StoreByRoutes() {
+    const Metrics::TransferScope scope;
+    Metrics::TransferTimer timer(kNone);
+
+    std::array<RE::ObjectRefHandle, kNone> routes;
+    {
+        std::lock_guard lock(g_routeMutex);
+        routes = g_routes;
+    }
+
+    // one bucket per distinct container; several categories may share one. Runs on the main thread only, so the
+    // buffers here are simply kept around between passes.
+    thread_local std::vector<Bucket> buckets;
+    thread_local std::vector<TransferQueue::Transfer> transfers;
+    thread_local std::vector<TransferPlanner::PlannedItem> planned;
+    std::array<std::size_t, kNone> bucket_of{};
+    std::uint32_t routed_mask = 0;
+    for (std::size_t type = 0; type < kNone; ++type) {
+        if (!routes[type]) continue;
+        const auto it = std::ranges::find(buckets, routes[type], &Bucket::container);
+        bucket_of[type] = static_cast<std::size_t>(std::distance(buckets.begin(), it));
+        if (it == buckets.end()) {
+            buckets.push_back({.container = routes[type],
+                               .entries = Scratch::Acquire<TransferPlanner::Entry>(),
+                               .objects = Scratch::Acquire<RE::TESBoundObject*>()});
+        }
+        routed_mask |= ItemTypeBit(static_cast<ItemTypes>(type));
+    }
+    if (buckets.empty()) return 0;
+
+    const auto player_ref = RE::PlayerCharacter::GetSingleton()->AsReference();
+    const auto lists = FormLists::GetSnapshot();
+    const float exclude_weight_limit = Settings::exclude_weightless_global->value;
+
+    const auto bucket_item = [&](RE::TESBoundObject* a_item, const std::int32_t a_count, const RE::InventoryEntryData* a_entry) {
+        const auto routed = FormLists::GetCategoryMask(a_item, *lists) & routed_mask;
+        if (!routed) return true;
+        const auto weight = a_item->GetWeight();
+        if (exclude_weight_limit > 0.f && weight < exclude_weight_limit) return true;
+
+        auto& bucket = buckets[bucket_of[std::bit_width(routed) - 1]];
+        bucket.entries.push_back({.formid = a_item->GetFormID(),
+                                  .count = a_count,
+                                  .weight = weight,
+                                  .value = a_item->GetGoldValue(),
+                                  .is_protected = a_entry && (a_entry->IsWorn() || a_entry->IsFavorited() || a_entry->IsQuestObject())});
+        bucket.objects.push_back(a_item);
+        return true;
+    };
+
+    // the player is always indexed, so this is normally a lookup rather than a walk
+    std::size_t scanned = 0;
+    thread_local Scratch::Vector<ContainerIndex::Candidate> candidates;
+    if (ContainerIndex::Lookup(player_ref, routed_mask, true, candidates)) {
+        for (const auto& [object, count, entry] : candidates) {
+            ++scanned;
+            bucket_item(object, count, entry);
+        }
+    } else {
+        const auto matches = [&](RE::TESBoundObject* a_item) {
+            if (a_item->Is(RE::FormType::LeveledItem) || !a_item->GetPlayable()) return false;
+            const auto mask = FormLists::GetCategoryMask(a_item, *lists);
+            return !(mask & FormLists::kExcludedBit) && (mask & routed_mask);
+        };
+        scanned = Inventory::ForEachItem(player_ref, matches, bucket_item);
+    }
+    timer.EndPhase(Metrics::TransferPhase::kFilter);
+
+    std::size_t moved = 0;
+    for (auto& [container_handle, entries, objects] : buckets) {
+        RE::TESObjectREFRPtr container;
+        RE::LookupReferenceByHandle(container_handle, container);
+        if (!container || entries.empty()) continue;
+
+        const TransferPlanner::Request request{.remaining_capacity = GetRemainingCapacity(container.get()),
+                                               .exclude_weight_limit = exclude_weight_limit};
+        TransferPlanner::Plan(entries, request, planned);
+        if (planned.empty()) continue;
+
+        auto& [target, items] = transfers.emplace_back(TransferQueue::Transfer{.target = container.get(),
+                                                                                .items = Scratch::Acquire<TransferQueue::Item>()});
+        items.reserve(planned.size());
+        for (const auto& [entry_index, count] : planned) {
+            items.push_back({.object = objects[entry_index], .count = count});
+        }
+        moved += items.size();
+    }
+    timer.EndPhase(Metrics::TransferPhase::kPlan);
+
+    for (auto& bucket : buckets) {
+        Scratch::Release(std::move(bucket.entries));
+        Scratch::Release(std::move(bucket.objects));
+    }
+    buckets.clear();
+
+    const auto containers = transfers.size();
+    timer.SetCounts(scanned, moved);
+    TransferQueue::Submit(player_ref, transfers, timer);
+    transfers.clear();
+
+    logger::info("Stored {} item stacks into {} containers", moved, containers);
+    return containers;
+}
@@ -0,0 +1,87 @@
+#include "TaskPool.h"
+
+namespace {
+    constexpr std::size_t MAX_WORKERS = 8;
+}
+
+TaskPool& TaskPool::GetSingleton() {
+    // never destroyed: the workers are detached and may still be parked when the process exits
+    static auto* singleton = [] {
+        const unsigned hw = std::thread::hardware_concurrency();
+        return new TaskPool(std::min<std::size_t>(hw > 1 ? hw - 1 : 1, MAX_WORKERS));
+    }();
+    return *singleton;
+}
+
+TaskPool::TaskPool(const std::size_t a_workerCount) {
+    _queues.reserve(a_workerCount + 1);
+    for (std::size_t i = 0; i <= a_workerCount; ++i) {
+        _queues.push_back(std::make_unique<Queue>());
+    }
+    for (std::size_t i = 1; i <= a_workerCount; ++i) {
+        _workers.emplace_back(&TaskPool::WorkerLoop, this, i).detach();
+    }
+    logger::info("Task pool started with {} workers", a_workerCount);
+}
+
+void TaskPool::Submit(Batch& a_batch, const std::size_t a_count) {
+    // deal the tasks out round-robin; stealing evens out whatever the split gets wrong
+    const auto queue_count = _queues.size();
+    for (std::size_t q = 0; q < queue_count; ++q) {
+        auto& queue = *_queues[q];
+        std::lock_guard lock(queue.mutex);
+        for (auto i = q; i < a_count; i += queue_count) {
+            queue.tasks.push_back({&a_batch, i});
+        }
+    }
+    {
+        std::lock_guard lock(_sleepMutex);
+        _queued.fetch_add(a_count, std::memory_order_release);
+    }
+    _wake.notify_all();
+}
+
+bool TaskPool::TryRunOne(const std::size_t a_self) {
+    std::optional<Task> task;
+    {
+        auto& own = *_queues[a_self];
+        std::lock_guard lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+        }
+    }
+    for (std::size_t offset = 1; !task && offset < _queues.size(); ++offset) {
+        auto& victim = *_queues[(a_self + offset) % _queues.size()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+        }
+    }
+    if (!task) return false;
+
+    _queued.fetch_sub(1, std::memory_order_relaxed);
+    const auto batch = task->batch;
+    batch->run(batch->context, task->index);
+    batch->remaining.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+void TaskPool::Help(Batch& a_batch) {
+    while (a_batch.remaining.load(std::memory_order_acquire) > 0) {
+        if (!TryRunOne(0)) {
+            // the last tasks are running elsewhere
+            std::this_thread::yield();
+        }
+    }
+}
+
+void TaskPool::WorkerLoop(const std::size_t a_self) {
+    while (true) {
+        if (TryRunOne(a_self)) continue;
+
+        std::unique_lock lock(_sleepMutex);
+        _wake.wait(lock, [this] { return _queued.load(std::memory_order_acquire) > 0; });
+    }
+}
@@ -0,0 +1,261 @@
+#include "TransferQueue.h"
+#include "PersistentTask.h"
+
+namespace {
+    struct Batch {
+        RE::ObjectRefHandle source;
+        RE::ObjectRefHandle target;
+        TransferQueue::Items items;
+        std::size_t next = 0;
+        // set on the last batch of each Submit call, and finished with it
+        std::optional<Metrics::TransferTimer> timer;
+    };
+
+    std::atomic<std::uint32_t> g_frameBudget{TransferQueue::DEFAULT_FRAME_BUDGET_US};
+
+    std::mutex g_queueMutex;
+    // flat FIFO: batches before g_head are done. Cleared (keeping its capacity) whenever it drains, so the
+    // queue itself stops allocating once it has held the usual number of batches.
+    Scratch::Vector<Batch> g_batches;
+    std::size_t g_head = 0;
+    // totals over the batches currently queued, reset once the queue drains
+    std::size_t g_itemsQueued = 0;
+    std::size_t g_itemsApplied = 0;
+
+    // Apply and menu refresh work since the last batch with a timer finished, i.e. for the Submit call whose timer
+    // finishes next: batches run in order and each call's batches are queued together. Runner only.
+    Metrics::Clock::duration g_groupApply{};
+    Metrics::Clock::duration g_groupUIEnqueue{};
+
+    // References whose inventory menu needs an update, sent by one UI task. The runner adds to it and the task swaps
+    // it with its own buffer, so neither gives up its capacity.
+    std::mutex g_refreshMutex;
+    Scratch::Vector<RE::ObjectRefHandle> g_refreshes;
+
+    void SendRefreshes() {
+        static Scratch::Vector<RE::ObjectRefHandle> refreshes;
+        {
+            std::lock_guard lock(g_refreshMutex);
+            refreshes.swap(g_refreshes);
+        }
+        for (const auto handle : refreshes) {
+            RE::TESObjectREFRPtr ref;
+            RE::LookupReferenceByHandle(handle, ref);
+            if (ref) RE::SendUIMessage::SendInventoryUpdateMessage(ref.get(), nullptr);
+        }
+        refreshes.clear();
+    }
+
+    void RefreshMenu(const RE::ObjectRefHandle a_ref) {
+        std::lock_guard lock(g_refreshMutex);
+        if (std::ranges::find(g_refreshes, a_ref) != g_refreshes.end()) return;
+        // the first pending refresh schedules the task; later ones ride along until it runs
+        if (g_refreshes.empty()) {
+            PersistentTask::AddUI<SendRefreshes>();
+        }
+        g_refreshes.push_back(a_ref);
+    }
+
+    // What the slice runner takes out of the queue in one step, to act on once g_queueMutex is released
+    struct Step {
+        RE::ObjectRefHandle source;
+        RE::ObjectRefHandle target;
+        TransferQueue::Item item;
+        std::array<RE::ObjectRefHandle, 2> refresh{};  // references to refresh, set when a batch finishes
+        std::optional<Metrics::TransferTimer> timer;   // of the batch that finished, to finish after the refresh
+        bool has_item = false;
+    };
+
+    // Takes the next item off the front batch, or finishes that batch. Returns false once the queue is empty or,
+    // with a_yield, after leaving the rest for the next frame. Caller holds g_queueMutex.
+    bool NextStepLocked(const bool a_yield, Step& a_step) {
+        a_step = {};
+        if (g_head >= g_batches.size()) {
+            g_batches.clear();
+            g_head = 0;
+            g_itemsQueued = 0;
+            g_itemsApplied = 0;
+            return false;
+        }
+
+        auto& batch = g_batches[g_head];
+        if (batch.next < batch.items.size()) {
+            if (a_yield) {
+                // drop the finished batches so a queue that never drains doesn't keep growing
+                g_batches.erase(g_batches.begin(), g_batches.begin() + static_cast<std::ptrdiff_t>(g_head));
+                g_head = 0;
+                return false;
+            }
+            a_step = {.source = batch.source, .target = batch.target, .item = batch.items[batch.next++], .has_item = true};
+            ++g_itemsApplied;
+            return true;
+        }
+
+        Scratch::Release(std::move(batch.items));
+        a_step.timer = std::move(batch.timer);
+        const auto& finished = g_batches[g_head++];
+        // a reference the next batch touches again is refreshed after that one instead, so a burst of
+        // transfers (or one routed store into many containers) refreshes each menu once
+        const auto touched_next = [&](const RE::ObjectRefHandle a_ref) {
+            return g_head < g_batches.size() && (g_batches[g_head].source == a_ref || g_batches[g_head].target == a_ref);
+        };
+        if (!touched_next(finished.source)) a_step.refresh[0] = finished.source;
+        if (!touched_next(finished.target)) a_step.refresh[1] = finished.target;
+        return true;
+    }
+
+    // Drops what is left of the front batch after its source or target went away
+    void DropFrontBatch(const RE::ObjectRefHandle a_source, const RE::ObjectRefHandle a_target) {
+        std::lock_guard lock(g_queueMutex);
+        if (g_head >= g_batches.size()) return;
+        auto& batch = g_batches[g_head];
+        if (batch.source != a_source || batch.target != a_target) return;
+        logger::warn("Transfer source or target unloaded, dropping {} queued items", batch.items.size() - batch.next);
+        g_itemsApplied += batch.items.size() - batch.next;
+        batch.next = batch.items.size();
+    }
+
+    // Works through the queue until the budget is spent. Returns true if batches are left for the next frame.
+    // Only one runner exists at a time: the Submit call that finds the queue idle, then the slices it schedules.
+    // g_queueMutex is held only while taking an item off the queue; RemoveItem runs without it, since it fires
+    // container-changed events whose handlers may come back here.
+    bool RunSlice() {
+        const Metrics::TransferScope scope;
+        const auto budget = std::chrono::microseconds(g_frameBudget.load(std::memory_order_relaxed));
+        const auto start = std::chrono::steady_clock::now();
+        bool applied_any = false;
+
+        RE::ObjectRefHandle source_handle;
+        RE::ObjectRefHandle target_handle;
+        RE::TESObjectREFRPtr source;
+        RE::TESObjectREFRPtr target;
+        Step step;
+        while (true) {
+            {
+                // at least one item per frame so a tiny budget still makes progress
+                const bool yield = applied_any && budget.count() > 0 && std::chrono::steady_clock::now() - start >= budget;
+                std::lock_guard lock(g_queueMutex);
+                if (!NextStepLocked(yield, step)) {
+                    return g_head < g_batches.size();
+                }
+            }
+
+            if (step.refresh[0] || step.refresh[1]) {
+                const auto enqueue_start = Metrics::Clock::now();
+                for (const auto ref : step.refresh) {
+                    if (ref) RefreshMenu(ref);
+                }
+                g_groupUIEnqueue += Metrics::Clock::now() - enqueue_start;
+            }
+            if (step.timer) {
+                step.timer->AddTime(Metrics::TransferPhase::kApply, std::exchange(g_groupApply, {}));
+                step.timer->AddTime(Metrics::TransferPhase::kUIEnqueue, std::exchange(g_groupUIEnqueue, {}));
+                step.timer->Finish();
+            }
+            if (!step.has_item) continue;
+
+            const auto apply_start = Metrics::Clock::now();
+            if (step.source != source_handle || step.target != target_handle) {
+                source_handle = step.source;
+                target_handle = step.target;
+                RE::LookupReferenceByHandle(source_handle, source);
+                RE::LookupReferenceByHandle(target_handle, target);
+            }
+            if (!source || !target) {
+                DropFrontBatch(source_handle, target_handle);
+                continue;
+            }
+            source->RemoveItem(step.item.object, step.item.count, RE::ITEM_REMOVE_REASON::kRemove, nullptr, target.get());
+            applied_any = true;
+            g_groupApply += Metrics::Clock::now() - apply_start;
+        }
+    }
+
+    // Caller holds g_queueMutex. Returns false if there was nothing to queue.
+    bool QueueLocked(RE::TESObjectREFR* a_source, RE::TESObjectREFR* a_target, TransferQueue::Items&& a_items) {
+        if (!a_target || a_items.empty()) {
+            Scratch::Release(std::move(a_items));
+            return false;
+        }
+        g_itemsQueued += a_items.size();
+        g_batches.push_back({.source = a_source->GetHandle(), .target = a_target->GetHandle(), .items = std::move(a_items)});
+        return true;
+    }
+
+    void RunNextSlice();
+
+    void ScheduleNextSlice() {
+        PersistentTask::Add<RunNextSlice>();
+    }
+
+    void RunNextSlice() {
+        if (RunSlice()) {
+            ScheduleNextSlice();
+        }
+    }
+}
+
+void TransferQueue::SetFrameBudget(const std::uint32_t a_microseconds) {
+    g_frameBudget.store(a_microseconds, std::memory_order_relaxed);
+    logger::info("Transfer frame budget set to {} us", a_microseconds);
+}
+
+std::uint32_t TransferQueue::GetFrameBudget() {
+    return g_frameBudget.load(std::memory_order_relaxed);
+}
+
+void TransferQueue::Submit(RE::TESObjectREFR* a_source, RE::TESObjectREFR* a_target, Items a_items, Metrics::TransferTimer a_timer) {
+    if (!a_source) return;
+
+    bool start_runner = false;
+    {
+        std::lock_guard lock(g_queueMutex);
+        const bool busy = g_head < g_batches.size();
+        if (!QueueLocked(a_source, a_target, std::move(a_items))) {
+            a_timer.Finish();
+            return;
+        }
+        g_batches.back().timer = a_timer;
+        start_runner = !busy;
+    }
+    if (start_runner && RunSlice()) {
+        ScheduleNextSlice();
+    }
+}
+
+void TransferQueue::Submit(RE::TESObjectREFR* a_source, const std::span<Transfer> a_transfers, Metrics::TransferTimer a_timer) {
+    if (!a_source) return;
+
+    bool start_runner = false;
+    {
+        std::lock_guard lock(g_queueMutex);
+        // a runner is already going; these batches go after the pending ones to keep their order
+        const bool busy = g_head < g_batches.size();
+        bool queued = false;
+        for (auto& [target, items] : a_transfers) {
+            queued |= QueueLocked(a_source, target, std::move(items));
+        }
+        if (!queued) {
+            a_timer.Finish();
+            return;
+        }
+        g_batches.back().timer = a_timer;
+        start_runner = !busy;
+    }
+    if (start_runner && RunSlice()) {
+        ScheduleNextSlice();
+    }
+}
+
+bool TransferQueue::IsQueued(const RE::ObjectRefHandle a_ref) {
+    std::lock_guard lock(g_queueMutex);
+    return std::ranges::any_of(g_batches.begin() + static_cast<std::ptrdiff_t>(g_head), g_batches.end(), [&](const Batch& a_batch) {
+        return a_batch.source == a_ref || a_batch.target == a_ref;
+    });
+}
+
+float TransferQueue::GetProgress() {
+    std::lock_guard lock(g_queueMutex);
+    if (g_itemsQueued == 0) return 1.f;
+    return static_cast<float>(g_itemsApplied) / static_cast<float>(g_itemsQueued);
+}
@@ -0,0 +1,141 @@
+#include "TransferRecorder.h"
+#include "InventoryVisitor.h"
+#include "OutfitCache.h"
+#include "TransferTrace.h"
+
+namespace {
+    static_assert(TransferTrace::kExcludedBit == FormLists::kExcludedBit);
+
+    // records are buffered and written out once this much is pending
+    constexpr std::size_t FLUSH_BYTES = 64 * 1024;
+
+    std::atomic<bool> g_recording{false};
+
+    std::mutex g_traceMutex;
+    std::FILE* g_file = nullptr;
+    TransferTrace::Writer g_writer;
+    TransferTrace::Snapshot g_snapshot;  // reused between snapshots
+    std::chrono::steady_clock::time_point g_started;
+    std::size_t g_records = 0;
+
+    std::uint64_t ElapsedMicros() {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - g_started).count());
+    }
+
+    void FlushLocked() {
+        const auto data = g_writer.Data();
+        if (g_file && !data.empty() && std::fwrite(data.data(), 1, data.size(), g_file) != data.size()) {
+            logger::error("Failed to write transfer trace, recording stopped");
+            std::fclose(g_file);
+            g_file = nullptr;
+            g_recording.store(false, std::memory_order_relaxed);
+        }
+        g_writer.Clear();
+    }
+
+    void AppendedLocked() {
+        ++g_records;
+        if (g_writer.Data().size() >= FLUSH_BYTES) {
+            FlushLocked();
+        }
+    }
+
+    std::size_t StopLocked() {
+        if (!g_file) return 0;
+        FlushLocked();
+        if (g_file) std::fclose(g_file);
+        g_file = nullptr;
+        g_recording.store(false, std::memory_order_relaxed);
+        return std::exchange(g_records, 0);
+    }
+}
+
+bool TransferRecorder::Start(const std::string_view a_name) {
+    const auto folder = SKSE::log::log_directory();
+    if (!folder || a_name.empty()) return false;
+    const auto path = *folder / std::format("{}.qittrace", a_name);
+
+    std::lock_guard lock(g_traceMutex);
+    if (const auto records = StopLocked()) {
+        logger::info("Transfer recording ended with {} records", records);
+    }
+    g_file = std::fopen(path.string().c_str(), "wb");
+    if (!g_file) {
+        logger::error("Cannot create transfer trace {}", path.string());
+        return false;
+    }
+
+    g_started = std::chrono::steady_clock::now();
+    g_writer.WriteHeader();
+    g_recording.store(true, std::memory_order_relaxed);
+    logger::info("Recording transfers to {}", path.string());
+    return true;
+}
+
+std::size_t TransferRecorder::Stop() {
+    std::lock_guard lock(g_traceMutex);
+    const auto records = StopLocked();
+    logger::info("Transfer recording stopped with {} records", records);
+    return records;
+}
+
+bool TransferRecorder::IsRecording() noexcept {
+    return g_recording.load(std::memory_order_relaxed);
+}
+
+void TransferRecorder::RecordRequest(const int a_action, const int a_subType) {
+    if (!IsRecording()) return;
+    std::lock_guard lock(g_traceMutex);
+    if (!g_file) return;
+    g_writer.Write(TransferTrace::Request{.time_us = ElapsedMicros(), .action = a_action, .subtype = a_subType});
+    AppendedLocked();
+}
+
+void TransferRecorder::RecordSnapshot(RE::TESObjectREFR* a_source, const std::uint32_t a_typeMask,
+                                      const TransferPlanner::Request& a_request, const FormID a_outfit,
+                                      const bool a_protectSpecials, const FormLists::Snapshot& a_lists,
+                                      const std::span<const ContainerIndex::Candidate> a_indexed) {
+    if (!IsRecording()) return;
+    std::lock_guard lock(g_traceMutex);
+    if (!g_file) return;
+
+    g_snapshot.time_us = ElapsedMicros();
+    g_snapshot.source = a_source->GetFormID();
+    g_snapshot.type_mask = a_typeMask;
+    g_snapshot.request = a_request;
+    g_snapshot.items.clear();
+
+    // same selection and counts as the transfer pass, but every category
+    const auto playable = [](RE::TESBoundObject* a_item) { return !a_item->Is(RE::FormType::LeveledItem) && a_item->GetPlayable(); };
+    Inventory::ForEachItem(a_source, playable, [&](RE::TESBoundObject* a_item, std::int32_t a_count, const RE::InventoryEntryData* a_entry) {
+        if (a_outfit > 0) {
+            a_count -= OutfitCache::GetOutfitCount(a_source->GetFormID(), a_outfit, a_item, a_entry);
+        }
+        g_snapshot.items.push_back({.formid = a_item->GetFormID(),
+                                    .count = a_count,
+                                    .weight = a_item->GetWeight(),
+                                    .value = a_item->GetGoldValue(),
+                                    .category_mask = FormLists::GetCategoryMask(a_item, a_lists),
+                                    .is_protected = a_protectSpecials && a_entry &&
+                                                    (a_entry->IsWorn() || a_entry->IsFavorited() || a_entry->IsQuestObject())});
+        return true;
+    });
+
+    // the walk above visits the matching items in the same relative order as the pass's own walk; an index lookup
+    // has an order of its own. Items the index did not return do not match, so where they go does not matter.
+    if (!a_indexed.empty()) {
+        std::unordered_map<FormID, std::size_t> rank;
+        rank.reserve(a_indexed.size());
+        for (std::size_t i = 0; i < a_indexed.size(); ++i) {
+            rank.try_emplace(a_indexed[i].object->GetFormID(), i);
+        }
+        std::ranges::stable_sort(g_snapshot.items, {}, [&](const TransferTrace::Item& a_item) {
+            const auto it = rank.find(a_item.formid);
+            return it != rank.end() ? it->second : a_indexed.size();
+        });
+    }
+
+    g_writer.Write(g_snapshot);
+    AppendedLocked();
+}
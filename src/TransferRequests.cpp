@@ -0,0 +1,144 @@
+#include "TransferRequests.h"
+#include "Metrics.h"
+#include "PersistentTask.h"
+#include "ScratchBuffers.h"
+#include "TransferQueue.h"
+#include "TransferWorker.h"
+#include "Utils.h"
+#include <bit>
+
+namespace {
+    struct PendingRequest {
+        RE::ObjectRefHandle container;
+        bool taking = false;
+        std::uint32_t type_mask = 0;
+    };
+
+    // Categories a source had nothing left in, valid only for the lists they were checked against
+    struct ExhaustedCategories {
+        std::uint32_t type_mask = 0;
+        std::weak_ptr<const FormLists::Snapshot> lists;
+    };
+
+    std::mutex g_requestMutex;
+    Scratch::Vector<PendingRequest> g_pending;
+    std::unordered_map<RefID, ExhaustedCategories> g_exhausted;
+
+    bool IsExhaustedLocked(const RefID a_source, const std::uint32_t a_typeMask,
+                           const std::shared_ptr<const FormLists::Snapshot>& a_lists) {
+        const auto it = g_exhausted.find(a_source);
+        return it != g_exhausted.end() && (it->second.type_mask & a_typeMask) == a_typeMask && it->second.lists.lock() == a_lists;
+    }
+
+    void MarkExhaustedLocked(const RefID a_source, const std::uint32_t a_typeMask,
+                             const std::shared_ptr<const FormLists::Snapshot>& a_lists) {
+        auto& exhausted = g_exhausted[a_source];
+        if (exhausted.lists.lock() != a_lists) {
+            exhausted = {.type_mask = 0, .lists = a_lists};
+        }
+        exhausted.type_mask |= a_typeMask;
+    }
+
+    void Drain();
+
+    // Adds a request to the pending ones, merged into one for the same container and direction.
+    // Returns true if it was merged. Caller holds g_requestMutex.
+    bool QueueLocked(const PendingRequest& a_request) {
+        const auto it = std::ranges::find_if(g_pending, [&](const PendingRequest& a_pending) {
+            return a_pending.container == a_request.container && a_pending.taking == a_request.taking;
+        });
+        if (it != g_pending.end()) {
+            it->type_mask |= a_request.type_mask;
+            return true;
+        }
+
+        // the first pending request schedules the drain; later ones ride along until it runs
+        if (g_pending.empty()) {
+            PersistentTask::Add<Drain>();
+        }
+        g_pending.push_back(a_request);
+        return false;
+    }
+
+    // A reference with a transfer still being planned or applied: its inventory and carry weight are not final yet,
+    // so a pass over it now would plan against counts and capacity that the earlier transfer is about to change
+    bool IsBusy(const RE::ObjectRefHandle a_ref) {
+        return TransferWorker::IsPending(a_ref) || TransferQueue::IsQueued(a_ref);
+    }
+
+    void Run(const PendingRequest& a_request) {
+        RE::TESObjectREFRPtr container;
+        RE::LookupReferenceByHandle(a_request.container, container);
+        if (!container) return;
+
+        const auto player_ref = RE::PlayerCharacter::GetSingleton()->AsReference();
+        RE::TESObjectREFR* akSource = a_request.taking ? container.get() : player_ref;
+        RE::TESObjectREFR* akTarget = a_request.taking ? player_ref : container.get();
+
+        if (IsBusy(akSource->GetHandle()) || IsBusy(akTarget->GetHandle())) {
+            // retried on the next drain, one frame later at the earliest
+            std::lock_guard lock(g_requestMutex);
+            QueueLocked(a_request);
+            return;
+        }
+
+        const auto lists = FormLists::GetSnapshot();
+        {
+            std::lock_guard lock(g_requestMutex);
+            if (IsExhaustedLocked(akSource->GetFormID(), a_request.type_mask, lists)) {
+                Metrics::RecordTransferRequest(Metrics::RequestOutcome::kDropped);
+                return;
+            }
+        }
+
+        Metrics::RecordTransferRequest(Metrics::RequestOutcome::kRun);
+        // single categories keep their dedicated kernel
+        const auto held = std::has_single_bit(a_request.type_mask)
+                                 ? Utils::TransferItemsOfType(akSource, akTarget, static_cast<ItemTypes>(std::countr_zero(a_request.type_mask)))
+                                 : Utils::TransferItemsOfTypes(akSource, akTarget, a_request.type_mask);
+        if (held == 0) {
+            std::lock_guard lock(g_requestMutex);
+            MarkExhaustedLocked(akSource->GetFormID(), a_request.type_mask, lists);
+        }
+    }
+
+    void Drain() {
+        const Metrics::TransferScope scope;
+        // swapped back and forth with g_pending, so neither gives up its capacity
+        static Scratch::Vector<PendingRequest> pending;
+        {
+            std::lock_guard lock(g_requestMutex);
+            pending.swap(g_pending);
+        }
+        for (const auto& request : pending) {
+            Run(request);
+        }
+        pending.clear();
+    }
+}
+
+void TransferRequests::Submit(const bool a_taking, const std::uint32_t a_typeMask) {
+    if (!a_typeMask) return;
+    const auto container = Utils::GetMenuContainer();
+    if (!container) return;
+    const auto handle = container->GetHandle();
+
+    const Metrics::TransferScope scope;
+    std::lock_guard lock(g_requestMutex);
+    if (QueueLocked({.container = handle, .taking = a_taking, .type_mask = a_typeMask})) {
+        Metrics::RecordTransferRequest(Metrics::RequestOutcome::kMerged);
+    }
+}
+
+void TransferRequests::OnInventoryChanged(const RefID a_container) {
+    std::lock_guard lock(g_requestMutex);
+    // cleared rather than erased, so marking the container again reuses its entry
+    if (const auto it = g_exhausted.find(a_container); it != g_exhausted.end()) {
+        it->second.type_mask = 0;
+    }
+}
+
+void TransferRequests::ResetExhausted() {
+    std::lock_guard lock(g_requestMutex);
+    g_exhausted.clear();
+}
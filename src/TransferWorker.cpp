@@ -0,0 +1,143 @@
+#include "TransferWorker.h"
+#include "PersistentTask.h"
+#include "TransferQueue.h"
+#include "Utils.h"
+
+namespace {
+    // Immutable once planned; only read by the commit task
+    struct Plan {
+        RE::ObjectRefHandle source;
+        RE::ObjectRefHandle target;
+        RE::ObjectRefHandle menu_container;
+        TransferQueue::Items items;
+        Metrics::TransferTimer timer;
+        std::size_t scanned = 0;
+    };
+
+    std::once_flag g_workerStarted;
+    std::mutex g_jobMutex;
+    std::condition_variable g_jobReady;
+    // swapped with the worker's own buffer on every wake-up, so both keep their capacity
+    Scratch::Vector<TransferWorker::Job> g_jobs;
+
+    // plans waiting for the commit task; the same swap as g_jobs, done on the main thread
+    std::mutex g_planMutex;
+    Scratch::Vector<Plan> g_plans;
+
+    // sources and targets of enqueued jobs until their plan is committed or discarded; main thread only
+    Scratch::Vector<RE::ObjectRefHandle> g_pendingRefs;
+
+    void ErasePending(const RE::ObjectRefHandle a_ref) {
+        if (const auto it = std::ranges::find(g_pendingRefs, a_ref); it != g_pendingRefs.end()) {
+            *it = g_pendingRefs.back();
+            g_pendingRefs.pop_back();
+        }
+    }
+
+    bool IsMenuStillOpen(const RE::ObjectRefHandle a_container) {
+        const auto container = Utils::GetMenuContainer();
+        return container && container->GetHandle() == a_container;
+    }
+
+    void Commit(Plan& a_plan) {
+        a_plan.timer.EndPhase(Metrics::TransferPhase::kCommitWait);
+        if (a_plan.menu_container && !IsMenuStillOpen(a_plan.menu_container)) {
+            logger::info("Container menu closed before the transfer was applied, discarding {} planned items",
+                         a_plan.items.size());
+            return;
+        }
+
+        RE::TESObjectREFRPtr source;
+        RE::TESObjectREFRPtr target;
+        RE::LookupReferenceByHandle(a_plan.source, source);
+        RE::LookupReferenceByHandle(a_plan.target, target);
+        if (!source || !target) return;
+
+        a_plan.timer.SetCounts(a_plan.scanned, a_plan.items.size());
+        TransferQueue::Submit(source.get(), target.get(), std::move(a_plan.items), a_plan.timer);
+    }
+
+    void CommitPending() {
+        const Metrics::TransferScope scope;
+        static Scratch::Vector<Plan> plans;
+        {
+            std::lock_guard lock(g_planMutex);
+            plans.swap(g_plans);
+        }
+        for (auto& plan : plans) {
+            Commit(plan);
+            ErasePending(plan.source);
+            ErasePending(plan.target);
+            // empty after a successful commit; a discarded plan's items go back here
+            Scratch::Release(std::move(plan.items));
+        }
+        plans.clear();
+    }
+
+    Plan MakePlan(TransferWorker::Job& a_job) {
+        thread_local std::vector<TransferPlanner::PlannedItem> planned;
+        TransferPlanner::Plan(a_job.entries, a_job.request, planned);
+
+        Plan plan{.source = a_job.source,
+                  .target = a_job.target,
+                  .menu_container = a_job.menu_container,
+                  .items = Scratch::Acquire<TransferQueue::Item>(),
+                  .timer = a_job.timer,
+                  .scanned = a_job.scanned};
+        plan.items.reserve(planned.size());
+        for (const auto& [entry_index, count] : planned) {
+            plan.items.push_back({.object = a_job.objects[entry_index], .count = count});
+        }
+        plan.timer.EndPhase(Metrics::TransferPhase::kPlan);
+        return plan;
+    }
+
+    [[noreturn]] void WorkerLoop() {
+        // the thread does nothing but plan transfers
+        const Metrics::TransferScope scope;
+        Scratch::Vector<TransferWorker::Job> jobs;
+        while (true) {
+            {
+                std::unique_lock lock(g_jobMutex);
+                g_jobReady.wait(lock, [] { return !g_jobs.empty(); });
+                jobs.swap(g_jobs);
+            }
+
+            // jobs are taken in order and committed through the task queue in that same order
+            for (auto& job : jobs) {
+                job.timer.EndPhase(Metrics::TransferPhase::kPlanWait);
+                auto plan = MakePlan(job);
+                Scratch::Release(std::move(job.entries));
+                Scratch::Release(std::move(job.objects));
+
+                std::lock_guard lock(g_planMutex);
+                // the first pending plan schedules the commit; later ones ride along until it runs
+                if (g_plans.empty()) {
+                    PersistentTask::Add<CommitPending>();
+                    plan.timer.EndPhase(Metrics::TransferPhase::kUIEnqueue);
+                }
+                g_plans.push_back(std::move(plan));
+            }
+            jobs.clear();
+        }
+    }
+}
+
+void TransferWorker::Enqueue(Job a_job) {
+    std::call_once(g_workerStarted, [] {
+        std::thread(WorkerLoop).detach();
+        logger::info("Transfer planning thread started");
+    });
+
+    g_pendingRefs.push_back(a_job.source);
+    g_pendingRefs.push_back(a_job.target);
+    {
+        std::lock_guard lock(g_jobMutex);
+        g_jobs.push_back(std::move(a_job));
+    }
+    g_jobReady.notify_one();
+}
+
+bool TransferWorker::IsPending(const RE::ObjectRefHandle a_ref) {
+    return std::ranges::find(g_pendingRefs, a_ref) != g_pendingRefs.end();
+}
@@ -1,4 +1,14 @@
 #include "Utils.h"
+#include "ContainerIndex.h"
+#include "InventoryVisitor.h"
+#include "Metrics.h"
+#include "OutfitCache.h"
+#include "PersistentTask.h"
+#include "StorageRoutes.h"
+#include "TransferQueue.h"
+#include "TransferRecorder.h"
+#include "TransferRequests.h"
+#include "TransferWorker.h"
 
 RE::TESObjectREFR* Utils::GetMenuContainer() {
     RE::TESObjectREFR* container = nullptr;
@@ -15,103 +25,182 @@ RE::TESObjectREFR* Utils::GetMenuContainer() {
     return container;
 }
 
-void Utils::TransferItemsOfType(RE::TESObjectREFR* akSource, RE::TESObjectREFR* akTarget, const ItemTypes item_type) {
-    if (!akSource || !akTarget) return;
-    if (!IsItemType(item_type)) return;
+namespace {
+    // Shared transfer loop; a_filter receives the item's category bitmask.
+    // Instantiated once per filter type so each category gets its own inlined loop.
+    // a_metricsSlot is the ItemTypes value the timings are recorded under (kNone for multi-category passes).
+    // Returns the number of matching entries the source holds, movable right now or not (protected, too heavy for the
+    // target, under the weight limit); 0 means the source has nothing left in these categories.
+    template <typename Filter>
+    std::size_t TransferItems(RE::TESObjectREFR* akSource, RE::TESObjectREFR* akTarget, const Filter a_filter, const std::size_t a_metricsSlot) {
+        Metrics::TransferTimer timer(a_metricsSlot);
 
-    float remaining_capacity = FLT_MAX;
-    if (!akTarget->IsPlayerRef()) {
-        if (const auto a_actor = akTarget->As<RE::Actor>()) {
-            if (const auto actor_val_owner = a_actor->AsActorValueOwner()) {
-                const auto total_capacity = actor_val_owner->GetActorValue(RE::ActorValue::kCarryWeight);
-                const auto current_weight = actor_val_owner->GetActorValue(RE::ActorValue::kInventoryWeight);
-                remaining_capacity = total_capacity - current_weight;
+        float remaining_capacity = FLT_MAX;
+        if (!akTarget->IsPlayerRef()) {
+            if (const auto a_actor = akTarget->As<RE::Actor>()) {
+                if (const auto actor_val_owner = a_actor->AsActorValueOwner()) {
+                    const auto total_capacity = actor_val_owner->GetActorValue(RE::ActorValue::kCarryWeight);
+                    const auto current_weight = actor_val_owner->GetActorValue(RE::ActorValue::kInventoryWeight);
+                    remaining_capacity = total_capacity - current_weight;
+                }
             }
         }
-    }
 
-    RE::FormID source_outfitID = 0;
+        RE::FormID source_outfitID = 0;
 
-    if (const auto a_actor = akSource->As<RE::Actor>(); a_actor && !a_actor->IsPlayerRef()) {
-        if (const auto source_npc = a_actor->GetActorBase()) {
-            if (const auto source_outfit = source_npc->defaultOutfit) {
-                source_outfitID = source_outfit->GetFormID();
+        if (const auto a_actor = akSource->As<RE::Actor>(); a_actor && !a_actor->IsPlayerRef()) {
+            if (const auto source_npc = a_actor->GetActorBase()) {
+                if (const auto source_outfit = source_npc->defaultOutfit) {
+                    source_outfitID = source_outfit->GetFormID();
+                }
             }
         }
-    }
 
-    const bool bExcludeSpecials = akSource->IsPlayerRef();
-    const auto filter_func = GetFilterFunc(item_type);
-    const auto exclude_weight_limit = Settings::exclude_weightless_global->value;
-    std::vector<std::pair<RE::TESBoundObject*, std::int32_t>> forms;
+        // held for the whole pass so a concurrent list reload cannot change the rules halfway through
+        const auto lists = FormLists::GetSnapshot();
+        const bool bExcludeSpecials = akSource->IsPlayerRef();
+        const float exclude_weight_limit = Settings::exclude_weightless_global->value;
+        const auto selection = Settings::value_density_selection.load(std::memory_order_relaxed) ? TransferPlanner::Selection::kValueDensity
+                                                                                                   : TransferPlanner::Selection::kGreedy;
 
-    for (const auto akSource_inv = akSource->GetInventory();
-         auto& [item,data] : akSource_inv) {
-        if (remaining_capacity <= 0.0f) break;
-        if (item->Is(RE::FormType::LeveledItem) || !item->GetPlayable()) {
-            continue;
-        }
+        // snapshot the matching entries, then let the planner decide what moves
+        auto entries = Scratch::Acquire<TransferPlanner::Entry>();
+        auto objects = Scratch::Acquire<RE::TESBoundObject*>();
 
-        auto count = data.first;
-
-        if (source_outfitID > 0) {
-            if (const auto xLists = data.second->extraLists) {
-                RE::TESObjectREFR::Count outfit_count = 0;
-                for (const auto& xList : *xLists) {
-                    if (!xList) continue;
-                    if (const auto xOutfit = xList->GetByType<RE::ExtraOutfitItem>()) {
-                        if (source_outfitID == xOutfit->id) {
-                            ++outfit_count;
-                        }
-                    }
-                }
-                count -= outfit_count;
+        const auto matches = [&](RE::TESBoundObject* a_item) {
+            if (a_item->Is(RE::FormType::LeveledItem) || !a_item->GetPlayable()) {
+                return false;
             }
-        }
+            const auto mask = FormLists::GetCategoryMask(a_item, *lists);
+            return !(mask & FormLists::kExcludedBit) && a_filter(mask);
+        };
 
-        if (count <= 0) {
-            continue;
-        }
-        if (exclude_weight_limit > 0.f && item->GetWeight() < exclude_weight_limit) {
-            continue;
-        }
-        if (auto a_formid = item->GetFormID(); FormLists::excluded_forms.contains(a_formid)) {
-            continue;
-        }
-        if (!filter_func(item)) {
-            continue;
+        // weight the greedy planner will take from what was collected so far; once it covers the remaining
+        // capacity nothing further can move, so the walk stops there. Value-density selection needs every candidate.
+        float claimed_weight = 0.f;
+        std::size_t held = 0;
+        const auto visit = [&](RE::TESBoundObject* a_item, std::int32_t a_count, const RE::InventoryEntryData* a_entry) {
+            // cheap rejections first; the planner would drop these anyway. They still count as held, since a
+            // changed limit makes them movable without the inventory changing.
+            const auto weight = a_item->GetWeight();
+            if (exclude_weight_limit > 0.f && weight < exclude_weight_limit) {
+                ++held;
+                return true;
+            }
+
+            if (source_outfitID > 0) {
+                a_count -= OutfitCache::GetOutfitCount(akSource->GetFormID(), source_outfitID, a_item, a_entry);
+            }
+            const bool is_protected = bExcludeSpecials && a_entry &&
+                                      (a_entry->IsWorn() || a_entry->IsFavorited() || a_entry->IsQuestObject());
+
+            entries.push_back({.formid = a_item->GetFormID(),
+                               .count = a_count,
+                               .weight = weight,
+                               .value = a_item->GetGoldValue(),
+                               .is_protected = is_protected});
+            objects.push_back(a_item);
+
+            // outfit copies are not held; an outfit change arrives as an equip event
+            if (a_count > 0) {
+                ++held;
+            }
+            if (a_count > 0 && !is_protected) {
+                claimed_weight += weight * static_cast<float>(a_count);
+            }
+            return selection == TransferPlanner::Selection::kValueDensity || claimed_weight < remaining_capacity;
+        };
+
+        // tracked containers answer from their index; anything else is walked
+        std::size_t scanned = 0;
+        // never leaves this thread, so it is simply kept around between transfers
+        thread_local Scratch::Vector<ContainerIndex::Candidate> candidates;
+        const bool indexed = ContainerIndex::Lookup(akSource, a_filter.type_mask, bExcludeSpecials || source_outfitID > 0, candidates);
+        if (indexed) {
+            for (const auto& [object, count, entry] : candidates) {
+                ++scanned;
+                if (!visit(object, count, entry)) break;
+            }
+        } else {
+            scanned = Inventory::ForEachItem(akSource, matches, visit);
         }
-        if (bExcludeSpecials && (data.second->IsWorn() || data.second->IsFavorited() || data.second->IsQuestObject())) {
-            continue;
+
+        const TransferPlanner::Request request{.remaining_capacity = remaining_capacity,
+                                               .exclude_weight_limit = exclude_weight_limit,
+                                               .selection = selection};
+        if (TransferRecorder::IsRecording()) {
+            // counted into the filter phase while a recording runs
+            TransferRecorder::RecordSnapshot(akSource, a_filter.type_mask, request, source_outfitID, bExcludeSpecials, *lists,
+                                             indexed ? std::span<const ContainerIndex::Candidate>(candidates)
+                                                     : std::span<const ContainerIndex::Candidate>());
         }
+        timer.EndPhase(Metrics::TransferPhase::kFilter);
 
-        const auto item_weight = item->GetWeight();
-        remaining_capacity -= item_weight * count;
-        if (remaining_capacity < 0.0f) {
-            count = static_cast<std::int32_t>(std::floor((remaining_capacity + item_weight * count) / item_weight));
-            if (count <= 0) break;
+        RE::ObjectRefHandle menu_container;
+        if (const auto container = Utils::GetMenuContainer(); container == akSource || container == akTarget) {
+            menu_container = container->GetHandle();
         }
-        
-        forms.emplace_back(item, count);
+
+        // planned on the worker, committed back here on a later task
+        TransferWorker::Enqueue({.source = akSource->GetHandle(),
+                                 .target = akTarget->GetHandle(),
+                                 .menu_container = menu_container,
+                                 .entries = std::move(entries),
+                                 .objects = std::move(objects),
+                                 .request = request,
+                                 .timer = timer,
+                                 .scanned = scanned});
+        return held;
     }
 
-    for (const auto& [item, count] : forms) {
-        akSource->RemoveItem(item, count, RE::ITEM_REMOVE_REASON::kRemove, nullptr, akTarget);
+    template <ItemTypes T>
+    struct ItemTypeFilter {
+        static constexpr std::uint32_t type_mask = ItemTypeBit(T);
+        constexpr bool operator()(const std::uint32_t a_mask) const noexcept { return a_mask & ItemTypeBit(T); }
+    };
+
+    // Matches any of several categories, used when one pass serves a multi-category request.
+    struct ItemTypeMaskFilter {
+        std::uint32_t type_mask;
+        constexpr bool operator()(const std::uint32_t a_mask) const noexcept { return a_mask & type_mask; }
+    };
+
+    using TransferKernel = std::size_t (*)(RE::TESObjectREFR*, RE::TESObjectREFR*);
+
+    template <ItemTypes T>
+    std::size_t TransferKernelFor(RE::TESObjectREFR* akSource, RE::TESObjectREFR* akTarget) {
+        return TransferItems(akSource, akTarget, ItemTypeFilter<T>{}, T);
     }
 
-    SKSE::GetTaskInterface()->AddUITask([akTarget, akSource]() {
-        RE::SendUIMessage::SendInventoryUpdateMessage(akTarget, nullptr);
-        RE::SendUIMessage::SendInventoryUpdateMessage(akSource, nullptr);
-    });
+    template <std::size_t... I>
+    constexpr std::array<TransferKernel, sizeof...(I)> MakeTransferKernels(std::index_sequence<I...>) {
+        return {&TransferKernelFor<static_cast<ItemTypes>(I)>...};
+    }
+
+    constexpr auto transfer_kernels = MakeTransferKernels(std::make_index_sequence<kNone>{});
+
+    void StoreByRoutesTask() {
+        StorageRoutes::StoreByRoutes();
+    }
 }
 
-void Utils::StartTransfer(RE::StaticFunctionTag*, const int iAction, const int iSubType) {
-    const bool bIsTaking = iAction > 0 && iAction < 10;
-    const auto container = GetMenuContainer();
-    const auto player_ref = RE::PlayerCharacter::GetSingleton()->AsReference();
-    RE::TESObjectREFR* akSource = bIsTaking ? container : player_ref;
-    RE::TESObjectREFR* akTarget = bIsTaking ? player_ref : container;
+std::size_t Utils::TransferItemsOfType(RE::TESObjectREFR* akSource, RE::TESObjectREFR* akTarget, const ItemTypes item_type) {
+    if (!akSource || !akTarget) return 0;
+    if (!IsItemType(item_type)) return 0;
+    return transfer_kernels[item_type](akSource, akTarget);
+}
+
+std::size_t Utils::TransferItemsOfTypes(RE::TESObjectREFR* akSource, RE::TESObjectREFR* akTarget, const std::uint32_t type_mask) {
+    if (!akSource || !akTarget) return 0;
+    if (!type_mask) return 0;
+    return TransferItems(akSource, akTarget, ItemTypeMaskFilter{type_mask}, kNone);
+}
+
+bool Utils::IsTakingAction(const int iAction) {
+    return iAction > 0 && iAction < 10;
+}
 
+ItemTypes Utils::GetItemType(const int iAction, const int iSubType) {
     auto type = kNone;
     if (iAction == 1 || iAction == 12) {
         if (iSubType == 0) type = kWeapon;
@@ -206,11 +295,118 @@ void Utils::StartTransfer(RE::StaticFunctionTag*, const int iAction, const int i
         }
     }
 
-    TransferItemsOfType(akSource, akTarget, type);
+    return type;
+}
+
+void Utils::StartTransfer(RE::StaticFunctionTag*, const int iAction, const int iSubType) {
+    TransferRecorder::RecordRequest(iAction, iSubType);
+    if (const auto type = GetItemType(iAction, iSubType); IsItemType(type)) {
+        TransferRequests::Submit(IsTakingAction(iAction), ItemTypeBit(type));
+    }
+}
+
+void Utils::StartTransferMulti(RE::StaticFunctionTag*, const std::vector<int> aiActions, const std::vector<int> aiSubTypes) {
+    if (aiActions.empty()) return;
+
+    // the first action decides the direction; all pairs must agree with it
+    const bool bIsTaking = IsTakingAction(aiActions.front());
+    std::uint32_t type_mask = 0;
+    for (std::size_t i = 0; i < aiActions.size(); ++i) {
+        const auto iAction = aiActions[i];
+        const auto iSubType = i < aiSubTypes.size() ? aiSubTypes[i] : 0;
+        TransferRecorder::RecordRequest(iAction, iSubType);
+        if (IsTakingAction(iAction) != bIsTaking) {
+            logger::warn("StartTransferMulti: action {} goes the other way, skipped", iAction);
+            continue;
+        }
+        if (const auto type = GetItemType(iAction, iSubType); IsItemType(type)) {
+            type_mask |= ItemTypeBit(type);
+        }
+    }
+
+    TransferRequests::Submit(bIsTaking, type_mask);
+}
+
+float Utils::ReloadFormLists(RE::StaticFunctionTag*) {
+    const auto start = std::chrono::steady_clock::now();
+    const bool changed = FormLists::ReloadFormLists(true);
+    const auto elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    logger::info("Form lists reloaded on request in {:.2f} ms{}", elapsed, changed ? "" : " (no files)");
+    return elapsed;
+}
+
+void Utils::SetFormListWatching(RE::StaticFunctionTag*, const bool abEnabled) {
+    Settings::watch_form_lists.store(abEnabled);
+    if (abEnabled) {
+        FormLists::StartWatchingFormLists();
+    }
+    logger::info("Form list watching {}", abEnabled ? "enabled" : "disabled");
+}
+
+std::string Utils::GetPerformanceReport(RE::StaticFunctionTag*) {
+    auto report = Metrics::BuildReport();
+    logger::info("Performance report:\n{}", report);
+    return report;
+}
+
+float Utils::GetTransferLatency(RE::StaticFunctionTag*, const int iAction, const int iSubType, const float afPercentile) {
+    return static_cast<float>(Metrics::GetTransferPercentile(GetItemType(iAction, iSubType), afPercentile));
+}
+
+void Utils::SetTransferFrameBudget(RE::StaticFunctionTag*, const int aiMicroseconds) {
+    TransferQueue::SetFrameBudget(static_cast<std::uint32_t>(std::max(aiMicroseconds, 0)));
+}
+
+float Utils::GetTransferProgress(RE::StaticFunctionTag*) {
+    return TransferQueue::GetProgress();
+}
+
+void Utils::SetValueDensitySelection(RE::StaticFunctionTag*, const bool abEnabled) {
+    Settings::value_density_selection.store(abEnabled, std::memory_order_relaxed);
+    logger::info("Value-density selection {}", abEnabled ? "enabled" : "disabled");
+}
+
+void Utils::SetStorageRoute(RE::StaticFunctionTag*, const int iAction, const int iSubType, RE::TESObjectREFR* akContainer) {
+    const auto type = GetItemType(iAction, iSubType);
+    if (akContainer) {
+        StorageRoutes::SetRoute(type, akContainer);
+    } else {
+        StorageRoutes::ClearRoute(type);
+    }
+}
+
+void Utils::ClearStorageRoutes(RE::StaticFunctionTag*) {
+    StorageRoutes::ClearAllRoutes();
+}
+
+bool Utils::StartTransferRecording(RE::StaticFunctionTag*, const std::string asName) {
+    return TransferRecorder::Start(asName);
+}
+
+int Utils::StopTransferRecording(RE::StaticFunctionTag*) {
+    return static_cast<int>(TransferRecorder::Stop());
+}
+
+void Utils::StoreByRoutes(RE::StaticFunctionTag*) {
+    const Metrics::TransferScope scope;
+    PersistentTask::Add<StoreByRoutesTask>();
 }
 
 bool Utils::PapyrusFunctions(RE::BSScript::IVirtualMachine* vm) {
     vm->RegisterFunction("StartTransfer", "QuickItemTransfer_Script", StartTransfer);
+    vm->RegisterFunction("StartTransferMulti", "QuickItemTransfer_Script", StartTransferMulti);
+    vm->RegisterFunction("ReloadFormLists", "QuickItemTransfer_Script", ReloadFormLists);
+    vm->RegisterFunction("SetFormListWatching", "QuickItemTransfer_Script", SetFormListWatching);
+    vm->RegisterFunction("GetPerformanceReport", "QuickItemTransfer_Script", GetPerformanceReport);
+    vm->RegisterFunction("GetTransferLatency", "QuickItemTransfer_Script", GetTransferLatency);
+    vm->RegisterFunction("SetTransferFrameBudget", "QuickItemTransfer_Script", SetTransferFrameBudget);
+    vm->RegisterFunction("GetTransferProgress", "QuickItemTransfer_Script", GetTransferProgress);
+    vm->RegisterFunction("SetValueDensitySelection", "QuickItemTransfer_Script", SetValueDensitySelection);
+    vm->RegisterFunction("SetStorageRoute", "QuickItemTransfer_Script", SetStorageRoute);
+    vm->RegisterFunction("ClearStorageRoutes", "QuickItemTransfer_Script", ClearStorageRoutes);
+    vm->RegisterFunction("StoreByRoutes", "QuickItemTransfer_Script", StoreByRoutes);
+    vm->RegisterFunction("StartTransferRecording", "QuickItemTransfer_Script", StartTransferRecording);
+    vm->RegisterFunction("StopTransferRecording", "QuickItemTransfer_Script", StopTransferRecording);
     return true;
 }
 
@@ -1,13 +1,27 @@
+#include "ContainerIndex.h"
+#include "Events.h"
+#include "OutfitCache.h"
+#include "StorageRoutes.h"
+#include "TransferRequests.h"
 #include "Utils.h"
 
 namespace {
     // ReSharper disable once CppParameterMayBeConstPtrOrRef
     void OnMessage(SKSE::MessagingInterface::Message* a_message) {
         if (a_message->type == SKSE::MessagingInterface::kDataLoaded) {
-            FormLists::GetAllFormLists();
             FormLists::LoadKeywords();
+            FormLists::BuildCategoryIndex();
+            FormLists::GetAllFormLists();
+            Events::Install();
             Settings::LoadSettings();
             SKSE::GetPapyrusInterface()->Register(Utils::PapyrusFunctions);
+        } else if (a_message->type == SKSE::MessagingInterface::kPreLoadGame ||
+                   a_message->type == SKSE::MessagingInterface::kNewGame) {
+            // per-reference state of the previous session must not leak into the next one
+            ContainerIndex::Reset();
+            StorageRoutes::ClearAllRoutes();
+            OutfitCache::Clear();
+            TransferRequests::ResetExhausted();
         }
     }
 }
@@ -17,6 +31,7 @@ SKSEPluginLoad(const SKSE::LoadInterface *skse) {
     Utils::SetupLog();
     logger::info("Plugin loaded");
     Init(skse);
+    FormLists::StartLoadingFormLists();
     SKSE::GetMessagingInterface()->RegisterListener(OnMessage);
     return true;
 }
\ No newline at end of file
@@ -0,0 +1,539 @@
+// Offline checker for the category TXT folders (Data/SKSE/Plugins/QuickItemTransfer).
+// Reports what the plugin only warns about at game start: lines it cannot parse, broken rules, forms listed twice
+// and forms that are in a category and in excludes/ at the same time. Optionally writes a normalized copy of the
+// folders (one sorted, deduplicated file per category) and measures parsing throughput on large packs.
+// Shares the line scanner and token parser with the plugin, so both read the files the same way.
+#include "FormListParser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using FormListParser::Token;
+
+    constexpr auto USAGE =
+        "usage: formlist-lint <config folder> [options]\n"
+        "  <config folder>         the folder holding raw_food/, cooked_food/, ..., excludes/\n"
+        "  --manifest <file>       load order stand-in: one plugin per line in load order, as in plugins.txt\n"
+        "                          (a leading '*' is ignored; .esl files and lines ending in ' light' are light\n"
+        "                          plugins). Plugin-local ids are checked against it and full FormIDs are\n"
+        "                          rewritten as plugin-local ids in the normalized output.\n"
+        "  --out <folder>          write one sorted, deduplicated file per category into <folder>/<category>/\n"
+        "  --threads <n>           files scanned in parallel (default: hardware threads)\n"
+        "  --throughput [<runs>]   scan the folders <runs> more times (default 5) and report lines/s\n"
+        "  --quiet                 only print errors and the summary\n";
+
+    template <typename... Args>
+    std::string Format(const char* a_format, const Args... a_args) {
+        const auto size = std::snprintf(nullptr, 0, a_format, a_args...);
+        std::string result(static_cast<std::size_t>(std::max(size, 0)), '\0');
+        std::snprintf(result.data(), result.size() + 1, a_format, a_args...);
+        return result;
+    }
+
+    std::string ToLower(const std::string_view a_str) {
+        std::string lower(a_str);
+        std::ranges::transform(lower, lower.begin(), [](const unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+        return lower;
+    }
+
+    struct Plugin {
+        std::string name;
+        bool light = false;
+        std::uint32_t index = 0;  // compile index among full or light plugins
+    };
+
+    // Stands in for the game's load order, so plugin-relative and full FormIDs can be told apart and checked
+    class Manifest {
+    public:
+        bool Load(const std::filesystem::path& a_path, std::string& a_error) {
+            std::string buffer;
+            if (!FormListParser::ReadFile(a_path, buffer)) {
+                a_error = "cannot open " + a_path.string();
+                return false;
+            }
+            bool ok = true;
+            FormListParser::ForEachEntry(buffer, [&](std::string_view a_line, const std::uint32_t a_lineNumber) {
+                if (!ok) return;
+                if (a_line.starts_with('*')) {
+                    a_line = FormListParser::Trim(a_line.substr(1));
+                }
+                bool light = false;
+                if (const auto space = a_line.find_last_of(FormListParser::kWhitespace); space != std::string_view::npos &&
+                                                                                          ToLower(a_line.substr(space + 1)) == "light") {
+                    light = true;
+                    a_line = FormListParser::Trim(a_line.substr(0, space));
+                }
+                auto key = ToLower(a_line);
+                light = light || key.ends_with(".esl");
+                if (_byName.contains(key)) {
+                    a_error = Format("%s:%u: %.*s is listed twice", a_path.string().c_str(), a_lineNumber,
+                                     static_cast<int>(a_line.size()), a_line.data());
+                    ok = false;
+                    return;
+                }
+
+                auto& slots = light ? _light : _full;
+                _byName.emplace(std::move(key), _plugins.size());
+                slots.push_back(_plugins.size());
+                _plugins.push_back({.name = std::string(a_line), .light = light, .index = static_cast<std::uint32_t>(slots.size() - 1)});
+            });
+            if (ok && (_full.size() > 0xFE || _light.size() > 0x1000)) {
+                a_error = "more plugins than the game can load";
+                ok = false;
+            }
+            return ok;
+        }
+
+        [[nodiscard]] const Plugin* Find(const std::string_view a_name) const {
+            const auto it = _byName.find(ToLower(a_name));
+            return it != _byName.end() ? &_plugins[it->second] : nullptr;
+        }
+
+        // The plugin a full FormID belongs to under this load order
+        [[nodiscard]] const Plugin* Owner(const std::uint32_t a_formID) const {
+            const auto index = a_formID >> 24;
+            if (index == 0xFE) {
+                const auto light_index = (a_formID >> 12) & 0xFFF;
+                return light_index < _light.size() ? &_plugins[_light[light_index]] : nullptr;
+            }
+            return index < _full.size() ? &_plugins[_full[index]] : nullptr;
+        }
+
+        [[nodiscard]] std::uint32_t ToGlobal(const Plugin& a_plugin, const std::uint32_t a_localID) const {
+            return a_plugin.light ? 0xFE000000u | (a_plugin.index << 12) | (a_localID & 0xFFFu)
+                                  : (a_plugin.index << 24) | (a_localID & 0xFFFFFFu);
+        }
+
+        [[nodiscard]] std::size_t size() const { return _plugins.size(); }
+
+    private:
+        std::vector<Plugin> _plugins;
+        std::unordered_map<std::string, std::size_t> _byName;
+        std::vector<std::size_t> _full;   // by compile index
+        std::vector<std::size_t> _light;  // by light compile index
+    };
+
+    enum class Severity : std::uint8_t { kError, kWarning, kNote };
+
+    struct Issue {
+        std::uint32_t line = 0;
+        Severity severity = Severity::kWarning;
+        std::string message;
+    };
+
+    // Output order within a category: plugin-local ids grouped by plugin, full ids, editor ids, rules, the rest
+    enum class Group : std::uint8_t { kPluginLocal, kFormID, kEditorID, kRule, kUnknown };
+
+    // One entry, reduced to what identifies its form however it was written
+    struct Record {
+        std::uint32_t line = 0;
+        Group group = Group::kUnknown;
+        std::string key{};       // identity for the duplicate and conflict checks
+        std::string sort_key{};  // order within the group
+        std::string text{};      // the normalized line
+    };
+
+    struct SourceFile {
+        std::filesystem::path path;
+        std::string display;  // <category>/<file name>
+        std::size_t category = 0;
+        std::string buffer{};
+        std::size_t lines = 0;
+        std::vector<Record> records{};
+        std::vector<Issue> issues{};
+        bool readable = true;
+    };
+
+    std::string Hex(const std::uint32_t a_id, const int a_digits) {
+        return Format("0x%0*X", a_digits, a_id);
+    }
+
+    // Turns one entry into its record. Returns false if the entry is dropped from the normalized output.
+    bool Normalize(const std::string_view a_entry, const Manifest* a_manifest, Record& a_record, std::vector<Issue>& a_issues) {
+        const auto issue = [&](const Severity a_severity, std::string a_message) {
+            a_issues.push_back({.line = a_record.line, .severity = a_severity, .message = std::move(a_message)});
+        };
+        const auto as_plugin_local = [&](const Plugin& a_plugin, const std::uint32_t a_localID) {
+            a_record.group = Group::kPluginLocal;
+            a_record.key = Format("g:%08X", a_manifest->ToGlobal(a_plugin, a_localID));
+            a_record.sort_key = ToLower(a_plugin.name) + '\0' + Hex(a_localID, 6);
+            a_record.text = Hex(a_localID, 6) + "~" + a_plugin.name;
+        };
+
+        auto token = FormListParser::ParseToken(a_entry);
+        switch (token.kind) {
+            case Token::Kind::kPluginLocal: {
+                const auto plugin = a_manifest ? a_manifest->Find(token.name) : nullptr;
+                if (a_manifest && !plugin) {
+                    issue(Severity::kError, Format("%.*s is not in the load order, the entry cannot resolve",
+                                                   static_cast<int>(token.name.size()), token.name.data()));
+                }
+                // the game keeps only the local part; a load order index written in front of it is dropped
+                const auto mask = plugin && plugin->light ? 0xFFFu : 0xFFFFFFu;
+                if (token.id & ~mask) {
+                    issue(Severity::kWarning, Format("upper digits of local id %s are ignored, it is read as %s",
+                                                     Hex(token.id, 6).c_str(), Hex(token.id & mask, 6).c_str()));
+                    token.id &= mask;
+                }
+                if (plugin) {
+                    as_plugin_local(*plugin, token.id);
+                } else {
+                    a_record.group = Group::kPluginLocal;
+                    a_record.key = "p:" + ToLower(token.name) + ':' + Hex(token.id, 6);
+                    a_record.sort_key = ToLower(token.name) + '\0' + Hex(token.id, 6);
+                    a_record.text = Hex(token.id, 6) + "~" + std::string(token.name);
+                }
+                return true;
+            }
+            case Token::Kind::kFormID: {
+                if (a_manifest) {
+                    // rewritten as plugin-local so the output no longer depends on the load order
+                    if (const auto plugin = a_manifest->Owner(token.id)) {
+                        as_plugin_local(*plugin, plugin->light ? token.id & 0xFFFu : token.id & 0xFFFFFFu);
+                        return true;
+                    }
+                    issue(Severity::kWarning, Format("%s points past the end of the load order", Hex(token.id, 8).c_str()));
+                }
+                a_record.group = Group::kFormID;
+                a_record.key = Format("g:%08X", token.id);
+                a_record.sort_key = Hex(token.id, 8);
+                a_record.text = a_record.sort_key;
+                return true;
+            }
+            case Token::Kind::kEditorID:
+                // editor ids are case-insensitive in the game
+                a_record.group = Group::kEditorID;
+                a_record.key = "e:" + ToLower(token.name);
+                a_record.sort_key = ToLower(token.name);
+                a_record.text = token.name;
+                return true;
+            case Token::Kind::kRule: {
+                std::vector<FormListParser::RuleCondition> conditions;
+                std::string_view error;
+                if (!FormListParser::ParseRule(token.name, conditions, error)) {
+                    issue(Severity::kError, Format("rule ignored: %.*s", static_cast<int>(error.size()), error.data()));
+                    return false;
+                }
+                // conditions separated by single spaces, so the same rule written twice is recognized
+                std::string normalized(FormListParser::kRulePrefix);
+                auto rest = token.name;
+                while (!(rest = FormListParser::Trim(rest)).empty()) {
+                    const auto end = std::min(rest.find_first_of(FormListParser::kWhitespace), rest.size());
+                    normalized += ' ';
+                    normalized += rest.substr(0, end);
+                    rest.remove_prefix(end);
+                }
+                a_record.group = Group::kRule;
+                a_record.key = "r:" + normalized;
+                a_record.sort_key = normalized;
+                a_record.text = std::move(normalized);
+                return true;
+            }
+            case Token::Kind::kUnknown:
+                issue(Severity::kWarning, "not a FormID, plugin-local id, editor id or rule; left to the game's form reader");
+                a_record.group = Group::kUnknown;
+                a_record.key = "u:" + std::string(a_entry);
+                a_record.sort_key = a_entry;
+                a_record.text = a_entry;
+                return true;
+        }
+        return false;
+    }
+
+    std::vector<SourceFile> ListFiles(const std::filesystem::path& a_root, std::vector<std::string>& a_notes) {
+        std::vector<SourceFile> files;
+        std::error_code ec;
+        for (std::size_t category = 0; category < FormListParser::kCategoryFolders.size(); ++category) {
+            const auto folder = FormListParser::kCategoryFolders[category];
+            const auto dirpath = a_root / folder;
+            if (!std::filesystem::is_directory(dirpath, ec)) {
+                a_notes.push_back(Format("note: no %.*s/ folder", static_cast<int>(folder.size()), folder.data()));
+                continue;
+            }
+            // same selection as the plugin: regular files ending in .txt, no recursion
+            for (std::filesystem::directory_iterator it(dirpath, ec), end; !ec && it != end; it.increment(ec)) {
+                if (!it->is_regular_file(ec) || it->path().extension() != ".txt") continue;
+                files.push_back({.path = it->path(),
+                                 .display = std::string(folder) + "/" + it->path().filename().string(),
+                                 .category = category});
+            }
+        }
+        // anything else in the config folder is ignored by the plugin, which is usually a misspelled folder name
+        for (std::filesystem::directory_iterator it(a_root, ec), end; !ec && it != end; it.increment(ec)) {
+            const auto name = it->path().filename().string();
+            if (it->is_directory(ec) && std::ranges::find(FormListParser::kCategoryFolders, name) == FormListParser::kCategoryFolders.end()) {
+                a_notes.push_back("warning: " + name + "/ is not a category folder and is ignored by the plugin");
+            } else if (it->is_regular_file(ec) && it->path().extension() == ".txt") {
+                a_notes.push_back("warning: " + name + " is outside of the category folders and is ignored by the plugin");
+            }
+        }
+        std::ranges::sort(files, {}, &SourceFile::display);
+        return files;
+    }
+
+    // Reads and normalizes every file, a_threads of them at a time. Each worker only writes to the files it took.
+    void ScanFiles(std::vector<SourceFile>& a_files, const Manifest* a_manifest, const std::size_t a_threads) {
+        std::atomic<std::size_t> next{0};
+        const auto work = [&]() {
+            for (auto index = next.fetch_add(1); index < a_files.size(); index = next.fetch_add(1)) {
+                auto& file = a_files[index];
+                file.records.clear();
+                file.issues.clear();
+                if (!FormListParser::ReadFile(file.path, file.buffer)) {
+                    file.readable = false;
+                    file.issues.push_back({.severity = Severity::kError, .message = "cannot be read"});
+                    continue;
+                }
+                file.lines = static_cast<std::size_t>(std::ranges::count(file.buffer, '\n')) +
+                             (!file.buffer.empty() && file.buffer.back() != '\n' ? 1 : 0);
+                FormListParser::ForEachEntry(file.buffer, [&](const std::string_view a_entry, const std::uint32_t a_line) {
+                    Record record{.line = a_line};
+                    if (Normalize(a_entry, a_manifest, record, file.issues)) {
+                        file.records.push_back(std::move(record));
+                    }
+                });
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (std::size_t i = 1; i < std::min(a_threads, a_files.size()); ++i) {
+            workers.emplace_back(work);
+        }
+        work();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    struct Occurrence {
+        std::size_t file = 0;
+        std::uint32_t line = 0;  // 0 if not listed in that category
+    };
+
+    // Checks every entry against all earlier ones and keeps the first of each form per category
+    std::array<std::vector<const Record*>, FormListParser::kCategoryFolders.size()> MergeCategories(std::vector<SourceFile>& a_files,
+                                                                                                     std::size_t& a_duplicates) {
+        const auto excludes = static_cast<std::size_t>(std::distance(
+            FormListParser::kCategoryFolders.begin(), std::ranges::find(FormListParser::kCategoryFolders, FormListParser::kExcludesFolder)));
+        const auto where = [&](const std::size_t a_current, const Occurrence& a_seen) {
+            return a_seen.file == a_current ? Format("line %u", a_seen.line)
+                                            : Format("%s:%u", a_files[a_seen.file].display.c_str(), a_seen.line);
+        };
+
+        std::array<std::vector<const Record*>, FormListParser::kCategoryFolders.size()> merged;
+        std::unordered_map<std::string_view, std::array<Occurrence, FormListParser::kCategoryFolders.size()>> seen;
+        for (std::size_t index = 0; index < a_files.size(); ++index) {
+            auto& file = a_files[index];
+            for (const auto& record : file.records) {
+                auto& occurrences = seen[record.key];
+                const auto issue = [&](const Severity a_severity, std::string a_message) {
+                    file.issues.push_back({.line = record.line, .severity = a_severity, .message = std::move(a_message)});
+                };
+
+                if (const auto& same = occurrences[file.category]; same.line != 0) {
+                    issue(Severity::kWarning, "duplicate of " + where(index, same));
+                    ++a_duplicates;
+                    continue;
+                }
+                for (std::size_t other = 0; other < occurrences.size(); ++other) {
+                    if (other == file.category || occurrences[other].line == 0) continue;
+                    const auto other_name = std::string(FormListParser::kCategoryFolders[other]);
+                    if (other == excludes) {
+                        issue(Severity::kWarning, "also excluded at " + where(index, occurrences[other]) + ", it is never transferred");
+                    } else if (file.category == excludes) {
+                        issue(Severity::kWarning, "excludes a form listed in " + other_name + " at " + where(index, occurrences[other]));
+                    } else {
+                        issue(Severity::kNote, "also listed in " + other_name + " at " + where(index, occurrences[other]));
+                    }
+                }
+                occurrences[file.category] = {.file = index, .line = record.line};
+                merged[file.category].push_back(&record);
+            }
+        }
+        return merged;
+    }
+
+    bool WriteNormalized(const std::filesystem::path& a_out, const std::size_t a_category, std::vector<const Record*>& a_records,
+                         const std::size_t a_sourceFiles) {
+        std::ranges::sort(a_records, [](const Record* a_lhs, const Record* a_rhs) {
+            return std::tie(a_lhs->group, a_lhs->sort_key) < std::tie(a_rhs->group, a_rhs->sort_key);
+        });
+
+        const auto folder = a_out / FormListParser::kCategoryFolders[a_category];
+        std::error_code ec;
+        std::filesystem::create_directories(folder, ec);
+        const auto path = folder / (std::string(FormListParser::kCategoryFolders[a_category]) + ".txt");
+
+        // every .txt in the folder is loaded, so leftovers would be read alongside the normalized file
+        for (std::filesystem::directory_iterator it(folder, ec), end; !ec && it != end; it.increment(ec)) {
+            if (it->path().extension() == ".txt" && it->path().filename() != path.filename()) {
+                std::fprintf(stderr, "warning: %s is loaded together with the normalized file\n", it->path().string().c_str());
+            }
+        }
+
+        const auto out = std::fopen(path.string().c_str(), "wb");
+        if (!out) {
+            std::fprintf(stderr, "error: cannot write %s\n", path.string().c_str());
+            return false;
+        }
+        std::fprintf(out, "# Normalized by formlist-lint from %zu files, %zu entries. Edit the sources and run it again.\n",
+                     a_sourceFiles, a_records.size());
+        for (const auto record : a_records) {
+            std::fputs(record->text.c_str(), out);
+            std::fputc('\n', out);
+        }
+        return std::fclose(out) == 0;
+    }
+
+    struct Options {
+        std::filesystem::path root;
+        std::optional<std::filesystem::path> manifest;
+        std::optional<std::filesystem::path> out;
+        std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        std::size_t throughput_runs = 0;
+        bool quiet = false;
+    };
+
+    bool ParseArguments(const int a_argc, char** a_argv, Options& a_options) {
+        for (int i = 1; i < a_argc; ++i) {
+            const std::string_view arg = a_argv[i];
+            const auto value = [&]() -> const char* { return i + 1 < a_argc ? a_argv[++i] : nullptr; };
+            if (arg == "--manifest") {
+                const auto path = value();
+                if (!path) return false;
+                a_options.manifest = path;
+            } else if (arg == "--out") {
+                const auto path = value();
+                if (!path) return false;
+                a_options.out = path;
+            } else if (arg == "--threads") {
+                const auto count = value();
+                if (!count || std::atoi(count) <= 0) return false;
+                a_options.threads = static_cast<std::size_t>(std::atoi(count));
+            } else if (arg == "--throughput") {
+                a_options.throughput_runs = 5;
+                if (i + 1 < a_argc && std::atoi(a_argv[i + 1]) > 0) {
+                    a_options.throughput_runs = static_cast<std::size_t>(std::atoi(a_argv[++i]));
+                }
+            } else if (arg == "--quiet") {
+                a_options.quiet = true;
+            } else if (!arg.starts_with("--") && a_options.root.empty()) {
+                a_options.root = arg;
+            } else {
+                return false;
+            }
+        }
+        return !a_options.root.empty();
+    }
+
+    void ReportThroughput(std::vector<SourceFile>& a_files, const Manifest* a_manifest, const Options& a_options) {
+        std::size_t lines = 0;
+        std::size_t bytes = 0;
+        for (const auto& file : a_files) {
+            lines += file.lines;
+            bytes += file.buffer.size();
+        }
+
+        double best = 0.0;
+        double total = 0.0;
+        for (std::size_t run = 0; run < a_options.throughput_runs; ++run) {
+            const auto start = Clock::now();
+            ScanFiles(a_files, a_manifest, a_options.threads);
+            const auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            total += seconds;
+            best = run == 0 ? seconds : std::min(best, seconds);
+        }
+        const auto mean = total / static_cast<double>(a_options.throughput_runs);
+        std::printf("throughput: %zu files, %zu lines, %.2f MB, %zu threads, %zu runs (read, parse and normalize)\n", a_files.size(),
+                    lines, static_cast<double>(bytes) / 1e6, a_options.threads, a_options.throughput_runs);
+        std::printf("  best %.2f ms: %.0f lines/s, %.1f MB/s\n", best * 1e3, static_cast<double>(lines) / best,
+                    static_cast<double>(bytes) / 1e6 / best);
+        std::printf("  mean %.2f ms: %.0f lines/s, %.1f MB/s\n", mean * 1e3, static_cast<double>(lines) / mean,
+                    static_cast<double>(bytes) / 1e6 / mean);
+    }
+}
+
+int main(int a_argc, char** a_argv) {
+    Options options;
+    if (!ParseArguments(a_argc, a_argv, options)) {
+        std::fputs(USAGE, stderr);
+        return 2;
+    }
+    std::error_code ec;
+    if (!std::filesystem::is_directory(options.root, ec)) {
+        std::fprintf(stderr, "error: %s is not a folder\n", options.root.string().c_str());
+        return 2;
+    }
+
+    Manifest manifest;
+    if (options.manifest) {
+        std::string error;
+        if (!manifest.Load(*options.manifest, error)) {
+            std::fprintf(stderr, "error: manifest: %s\n", error.c_str());
+            return 2;
+        }
+    }
+    const auto manifest_ptr = options.manifest ? &manifest : nullptr;
+
+    std::vector<std::string> notes;
+    auto files = ListFiles(options.root, notes);
+
+    const auto scan_start = Clock::now();
+    ScanFiles(files, manifest_ptr, options.threads);
+    const auto scan_time = Clock::now() - scan_start;
+
+    std::size_t duplicates = 0;
+    auto merged = MergeCategories(files, duplicates);
+
+    std::array<std::size_t, 3> counts{};  // by Severity
+    constexpr std::array<const char*, 3> severity_names = {"error", "warning", "note"};
+    for (const auto& note : notes) {
+        std::fprintf(stderr, "%s\n", note.c_str());
+    }
+    for (auto& file : files) {
+        std::ranges::stable_sort(file.issues, {}, &Issue::line);
+        for (const auto& [line, severity, message] : file.issues) {
+            ++counts[static_cast<std::size_t>(severity)];
+            if (options.quiet && severity != Severity::kError) continue;
+            std::printf("%s:%u: %s: %s\n", file.display.c_str(), line, severity_names[static_cast<std::size_t>(severity)], message.c_str());
+        }
+    }
+
+    std::size_t entries = 0;
+    for (const auto& file : files) {
+        entries += file.records.size();
+    }
+    std::printf("%zu files, %zu entries scanned in %.2f ms%s: %zu errors, %zu warnings, %zu notes, %zu duplicates\n", files.size(),
+                entries, std::chrono::duration<double, std::milli>(scan_time).count(),
+                options.manifest ? Format(" against %zu plugins", manifest.size()).c_str() : "", counts[0], counts[1], counts[2],
+                duplicates);
+
+    bool written = true;
+    if (options.out) {
+        if (std::filesystem::equivalent(*options.out, options.root, ec)) {
+            std::fprintf(stderr, "error: --out must not be the config folder itself\n");
+            return 2;
+        }
+        for (std::size_t category = 0; category < merged.size(); ++category) {
+            const auto sources = static_cast<std::size_t>(std::ranges::count(files, category, &SourceFile::category));
+            if (sources == 0) continue;
+            written = WriteNormalized(*options.out, category, merged[category], sources) && written;
+        }
+        if (written) {
+            std::printf("normalized lists written to %s\n", options.out->string().c_str());
+        }
+    }
+
+    if (options.throughput_runs > 0) {
+        ReportThroughput(files, manifest_ptr, options);
+    }
+    return counts[0] == 0 && written ? 0 : 1;
+}
@@ -0,0 +1,183 @@
+#pragma once
+// The few CommonLibSSE types the plugin's category predicates touch (Settings.h, src/Settings.cpp), so the tools can
+// run the real predicates without the game. Names and signatures follow CommonLibSSE; the behaviour follows the game
+// where it matters for cost: As<> is an RTTI cast like the game's, and keyword checks walk the form's keyword array.
+// Forms register themselves on construction and live until exit, as loaded forms do in the game.
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace RE {
+    using FormID = std::uint32_t;
+
+    // values as in the game
+    enum class FormType : std::uint8_t {
+        None = 0,
+        Keyword = 4,
+        Global = 9,
+        Scroll = 23,
+        Armor = 26,
+        Book = 27,
+        Ingredient = 30,
+        Light = 31,
+        Misc = 32,
+        Weapon = 41,
+        Ammo = 42,
+        KeyMaster = 45,
+        AlchemyItem = 46,
+        SoulGem = 52,
+        LeveledItem = 53
+    };
+
+    class TESForm;
+
+    namespace detail {
+        struct FormRegistry {
+            std::unordered_map<FormID, TESForm*> by_id;
+            std::unordered_map<FormType, std::vector<TESForm*>> by_type;
+        };
+
+        inline FormRegistry& GetFormRegistry() {
+            static FormRegistry registry;
+            return registry;
+        }
+    }
+
+    class TESForm {
+    public:
+        TESForm(const FormID a_formID, const FormType a_formType) : formID(a_formID), formType(a_formType) {
+            auto& registry = detail::GetFormRegistry();
+            registry.by_id[a_formID] = this;
+            registry.by_type[a_formType].push_back(this);
+        }
+        virtual ~TESForm() = default;
+        TESForm(const TESForm&) = delete;
+        TESForm& operator=(const TESForm&) = delete;
+
+        [[nodiscard]] FormID GetFormID() const noexcept { return formID; }
+        [[nodiscard]] FormType GetFormType() const noexcept { return formType; }
+        [[nodiscard]] bool Is(const FormType a_type) const noexcept { return formType == a_type; }
+        [[nodiscard]] bool IsDynamicForm() const noexcept { return (formID >> 24) == 0xFF; }
+        [[nodiscard]] bool IsArmor() const noexcept { return Is(FormType::Armor); }
+        [[nodiscard]] bool IsSoulGem() const noexcept { return Is(FormType::SoulGem); }
+
+        template <class T>
+        T* As() noexcept {
+            return dynamic_cast<T*>(this);
+        }
+        template <class T>
+        const T* As() const noexcept {
+            return dynamic_cast<const T*>(this);
+        }
+
+        template <class T = TESForm>
+        static T* LookupByID(const FormID a_formID) {
+            const auto& by_id = detail::GetFormRegistry().by_id;
+            const auto it = by_id.find(a_formID);
+            return it != by_id.end() ? it->second->As<T>() : nullptr;
+        }
+
+        FormID formID;
+        FormType formType;
+    };
+
+    class BGSKeyword : public TESForm {
+    public:
+        explicit BGSKeyword(const FormID a_formID) : TESForm(a_formID, FormType::Keyword) {}
+    };
+
+    class TESGlobal : public TESForm {
+    public:
+        explicit TESGlobal(const FormID a_formID) : TESForm(a_formID, FormType::Global) {}
+
+        float value = 0.f;
+    };
+
+    class BGSKeywordForm {
+    public:
+        virtual ~BGSKeywordForm() = default;
+
+        [[nodiscard]] bool HasKeyword(const BGSKeyword* a_keyword) const {
+            for (const auto keyword : keywords) {
+                if (keyword == a_keyword) return true;
+            }
+            return false;
+        }
+
+        std::vector<BGSKeyword*> keywords;
+    };
+
+    class TESBoundObject : public TESForm {
+    public:
+        using TESForm::TESForm;
+    };
+
+    class BGSBipedObjectForm {
+    public:
+        enum class ArmorType : std::uint32_t { kLightArmor, kHeavyArmor, kClothing };
+        static constexpr std::uint32_t kShieldSlot = 1u << 9;
+
+        virtual ~BGSBipedObjectForm() = default;
+
+        [[nodiscard]] bool IsShield() const noexcept { return (slots & kShieldSlot) != 0; }
+        [[nodiscard]] bool IsClothing() const noexcept { return armorType == ArmorType::kClothing; }
+
+        std::uint32_t slots = 0;
+        ArmorType armorType = ArmorType::kLightArmor;
+    };
+
+    class TESObjectARMO : public TESBoundObject, public BGSKeywordForm, public BGSBipedObjectForm {
+    public:
+        explicit TESObjectARMO(const FormID a_formID) : TESBoundObject(a_formID, FormType::Armor) {}
+    };
+
+    class TESObjectWEAP : public TESBoundObject, public BGSKeywordForm {
+    public:
+        explicit TESObjectWEAP(const FormID a_formID) : TESBoundObject(a_formID, FormType::Weapon) {}
+    };
+
+    class AlchemyItem : public TESBoundObject, public BGSKeywordForm {
+    public:
+        explicit AlchemyItem(const FormID a_formID) : TESBoundObject(a_formID, FormType::AlchemyItem) {}
+
+        [[nodiscard]] bool IsFood() const noexcept { return food; }
+        [[nodiscard]] bool IsPoison() const noexcept { return poison; }
+
+        bool food = false;
+        bool poison = false;
+    };
+
+    class TESObjectBOOK : public TESBoundObject, public BGSKeywordForm {
+    public:
+        explicit TESObjectBOOK(const FormID a_formID) : TESBoundObject(a_formID, FormType::Book) {}
+
+        [[nodiscard]] bool TeachesSkill() const noexcept { return teaches_skill; }
+        [[nodiscard]] bool TeachesSpell() const noexcept { return teaches_spell; }
+
+        bool teaches_skill = false;
+        bool teaches_spell = false;
+    };
+
+    // Stands in for every other inventory form type (ammo, scrolls, ingredients, keys, soul gems, lights, misc items)
+    class TESObjectMISC : public TESBoundObject, public BGSKeywordForm {
+    public:
+        TESObjectMISC(const FormID a_formID, const FormType a_formType) : TESBoundObject(a_formID, a_formType) {}
+    };
+
+    class TESDataHandler {
+    public:
+        static TESDataHandler* GetSingleton() {
+            static TESDataHandler singleton;
+            return &singleton;
+        }
+
+        std::vector<TESForm*>& GetFormArray(const FormType a_formType) { return detail::GetFormRegistry().by_type[a_formType]; }
+
+        // the tools load no plugins, so a local id is the form id
+        template <class T>
+        T* LookupForm(const FormID a_localFormID, std::string_view) {
+            return TESForm::LookupByID<T>(a_localFormID);
+        }
+    };
+}
@@ -0,0 +1,29 @@
+#pragma once
+// Stands in for the plugin's precompiled header (include/PCH.h) when a tool compiles one of the plugin's own
+// sources: the standard library, the game types from GameShim.h, FormID, and a logger the tools drop.
+#include "GameShim.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using namespace std::literals;
+
+using FormID = RE::FormID;
+
+namespace logger {
+    template <typename... Args>
+    void info(std::string_view, Args&&...) {}
+    template <typename... Args>
+    void warn(std::string_view, Args&&...) {}
+    template <typename... Args>
+    void error(std::string_view, Args&&...) {}
+}
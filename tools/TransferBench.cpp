@@ -0,0 +1,987 @@
+// Synthetic benchmarks for the transfer hot path and the form list loader, runnable without the game.
+// Inventories and category folders are generated from a seed instead of recorded (tools/TransferReplay.cpp replays
+// real sessions), so every release can be measured against the same inputs. Each result is printed as one JSON
+// object per line; collect them with e.g. `transfer-bench > results.jsonl` and compare between releases.
+// FormID comes from PluginShim.h, which the build includes first
+#include "ConcurrentFormSet.h"
+#include "FormListParser.h"
+#include "FrozenFormSet.h"
+#include "ScratchBuffers.h"
+#include "Settings.h"
+#include "TaskPool.h"
+#include "TransferTrace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr auto USAGE =
+        "usage: transfer-bench [suite...] [options]\n"
+        "  suites: planner, selection, loader, formset, kernels, parser, frozen, allocs, pool (default: all)\n"
+        "  --sizes <n,n,...>     inventory sizes for the planner suite (default 10,100,1000,10000,50000)\n"
+        "  --extra <fraction>    share of stacks split by extra lists (worn, favorited) (default 0.1)\n"
+        "  --lines <n>           lines across all generated category files for the loader suite, and of the one file\n"
+        "                        of the parser suite (default 100000)\n"
+        "  --runs <n>            measurements per case; the best one is reported (default 5)\n"
+        "  --threads <n>         most threads of the concurrent suites, which run 1, 2, 4, ... up to it\n"
+        "                        (default: hardware threads, at least 4)\n"
+        "  --seed <n>            seed of the generated inputs (default 1)\n";
+
+    struct Options {
+        std::vector<std::string> suites;
+        std::vector<std::size_t> sizes = {10, 100, 1000, 10000, 50000};
+        double extra = 0.1;
+        std::size_t lines = 100000;
+        std::size_t runs = 5;
+        std::size_t threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 4);
+        std::uint32_t seed = 1;
+    };
+
+    std::vector<std::size_t> ParseSizes(const std::string_view a_list) {
+        std::vector<std::size_t> sizes;
+        for (std::size_t pos = 0; pos <= a_list.size();) {
+            const auto comma = std::min(a_list.find(',', pos), a_list.size());
+            const auto size = std::strtoull(std::string(a_list.substr(pos, comma - pos)).c_str(), nullptr, 10);
+            if (size == 0) return {};
+            sizes.push_back(static_cast<std::size_t>(size));
+            pos = comma + 1;
+        }
+        return sizes;
+    }
+
+    bool ParseArguments(const int a_argc, char** a_argv, Options& a_options) {
+        for (int i = 1; i < a_argc; ++i) {
+            const std::string_view arg = a_argv[i];
+            const bool has_value = i + 1 < a_argc;
+            if (arg == "--sizes" && has_value) {
+                a_options.sizes = ParseSizes(a_argv[++i]);
+                if (a_options.sizes.empty()) return false;
+            } else if (arg == "--extra" && has_value) {
+                a_options.extra = std::atof(a_argv[++i]);
+                if (a_options.extra < 0.0 || a_options.extra > 1.0) return false;
+            } else if (arg == "--lines" && has_value) {
+                a_options.lines = static_cast<std::size_t>(std::strtoull(a_argv[++i], nullptr, 10));
+                if (a_options.lines == 0) return false;
+            } else if (arg == "--runs" && has_value) {
+                a_options.runs = static_cast<std::size_t>(std::strtoull(a_argv[++i], nullptr, 10));
+                if (a_options.runs == 0) return false;
+            } else if (arg == "--threads" && has_value) {
+                a_options.threads = static_cast<std::size_t>(std::strtoull(a_argv[++i], nullptr, 10));
+                if (a_options.threads == 0) return false;
+            } else if (arg == "--seed" && has_value) {
+                a_options.seed = static_cast<std::uint32_t>(std::strtoul(a_argv[++i], nullptr, 10));
+            } else if (!arg.starts_with("--")) {
+                a_options.suites.emplace_back(arg);
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Best time of one call of a_func over a_runs measurements, in nanoseconds. Each measurement repeats the call
+    // until it has run for a while, so short cases are not lost in the clock's resolution.
+    template <typename Func>
+    double BestNanoseconds(const std::size_t a_runs, Func&& a_func) {
+        constexpr auto MIN_DURATION = std::chrono::milliseconds(20);
+        double best = 0.0;
+        for (std::size_t run = 0; run < a_runs; ++run) {
+            std::size_t calls = 0;
+            const auto start = Clock::now();
+            auto elapsed = Clock::duration::zero();
+            do {
+                a_func();
+                ++calls;
+                elapsed = Clock::now() - start;
+            } while (elapsed < MIN_DURATION);
+            const auto ns = std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(calls);
+            if (run == 0 || ns < best) best = ns;
+        }
+        return best;
+    }
+
+    // 1, 2, 4, ... and a_max itself
+    std::vector<std::size_t> ThreadCounts(const std::size_t a_max) {
+        std::vector<std::size_t> counts;
+        for (std::size_t count = 1; count < a_max; count *= 2) {
+            counts.push_back(count);
+        }
+        counts.push_back(a_max);
+        return counts;
+    }
+
+    // ---- planner: category filter and plan over generated inventories ----
+
+    constexpr std::size_t CATEGORY_COUNT = 8;
+
+    struct CategoryMix {
+        const char* name;
+        std::uint32_t type_mask;  // requested categories, out of CATEGORY_COUNT evenly spread ones
+    };
+    constexpr CategoryMix category_mixes[] = {{"one", 0x01}, {"half", 0x0F}, {"all", 0xFF}};
+
+    // An inventory of a_size stacks spread over the categories, 2% of them excluded. a_extra of the stacks carry
+    // extra lists, which split them into a worn or favorited part (protected on the player) and the rest.
+    TransferTrace::Snapshot MakeInventory(const std::size_t a_size, const double a_extra, std::mt19937& a_random) {
+        std::uniform_int_distribution<std::uint32_t> category(0, CATEGORY_COUNT - 1);
+        std::uniform_int_distribution<std::int32_t> count(1, 20);
+        std::uniform_int_distribution<std::int32_t> value(0, 500);
+        std::lognormal_distribution<float> weight(-1.0f, 1.5f);  // mostly light, with a tail of heavy gear
+        std::bernoulli_distribution excluded(0.02);
+        std::bernoulli_distribution weightless(0.05);
+        std::bernoulli_distribution extra(a_extra);
+
+        TransferTrace::Snapshot snapshot;
+        snapshot.items.reserve(a_size);
+        for (std::uint32_t i = 0; snapshot.items.size() < a_size; ++i) {
+            TransferTrace::Item item{.formid = 0x01000000u + i,
+                                     .count = count(a_random),
+                                     .weight = weightless(a_random) ? 0.f : weight(a_random),
+                                     .value = value(a_random),
+                                     .category_mask = (1u << category(a_random)) | (excluded(a_random) ? TransferTrace::kExcludedBit : 0u)};
+            if (extra(a_random) && snapshot.items.size() + 1 < a_size) {
+                auto split = item;
+                split.count = 1;
+                split.is_protected = true;
+                snapshot.items.push_back(split);
+            }
+            snapshot.items.push_back(item);
+        }
+        return snapshot;
+    }
+
+    // Weight of what the requested categories hold, so a capacity limit binds whatever the mix
+    float MatchingWeight(const TransferTrace::Snapshot& a_snapshot) {
+        float total = 0.f;
+        for (const auto& item : a_snapshot.items) {
+            if (!(item.category_mask & TransferTrace::kExcludedBit) && (item.category_mask & a_snapshot.type_mask)) {
+                total += item.weight * static_cast<float>(item.count);
+            }
+        }
+        return total;
+    }
+
+    bool RunPlannerSuite(const Options& a_options) {
+        struct Limit {
+            const char* name;
+            float capacity_share;  // of the matching weight; 0 is unlimited
+            float exclude_weight_limit;
+        };
+        constexpr Limit limits[] = {{"unlimited", 0.f, 0.f}, {"capacity", 0.25f, 0.f}, {"capacity+weightless", 0.25f, 0.1f}};
+        constexpr std::pair<const char*, TransferPlanner::Selection> selections[] = {{"greedy", TransferPlanner::Selection::kGreedy},
+                                                                                     {"density", TransferPlanner::Selection::kValueDensity}};
+
+        std::mt19937 random(a_options.seed);
+        std::vector<TransferPlanner::Entry> entries;
+        std::vector<TransferPlanner::PlannedItem> planned;
+        for (const auto size : a_options.sizes) {
+            auto snapshot = MakeInventory(size, a_options.extra, random);
+            for (const auto& [mix_name, type_mask] : category_mixes) {
+                snapshot.type_mask = type_mask;
+                const auto matching_weight = MatchingWeight(snapshot);
+                for (const auto& [limit_name, capacity_share, exclude_weight_limit] : limits) {
+                    for (const auto& [selection_name, selection] : selections) {
+                        const TransferPlanner::Request request{
+                            .remaining_capacity = capacity_share > 0.f ? matching_weight * capacity_share : FLT_MAX,
+                            .exclude_weight_limit = exclude_weight_limit,
+                            .selection = selection};
+                        const auto ns = BestNanoseconds(a_options.runs, [&]() {
+                            TransferTrace::Filter(snapshot, request, entries);
+                            TransferPlanner::Plan(entries, request, planned);
+                        });
+                        std::printf("{\"suite\":\"planner\",\"entries\":%zu,\"mix\":\"%s\",\"limit\":\"%s\",\"selection\":\"%s\","
+                                    "\"matching\":%zu,\"planned\":%zu,\"ns_per_pass\":%.1f,\"ns_per_entry\":%.2f}\n",
+                                    size, mix_name, limit_name, selection_name, entries.size(), planned.size(), ns,
+                                    ns / static_cast<double>(size));
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    // ---- selection: greedy against value density on one large inventory ----
+
+    // Both selections over the same 10,000-stack inventory for a range of capacities: what each one costs and what
+    // it gets into the target. density_gain is the value density selection moved over what greedy moved.
+    bool RunSelectionSuite(const Options& a_options) {
+        constexpr std::size_t ENTRIES = 10000;
+        constexpr float capacity_shares[] = {0.01f, 0.05f, 0.25f, 0.5f, 0.9f};
+
+        std::mt19937 random(a_options.seed);
+        auto snapshot = MakeInventory(ENTRIES, a_options.extra, random);
+        snapshot.type_mask = category_mixes[std::size(category_mixes) - 1].type_mask;
+        const auto matching_weight = MatchingWeight(snapshot);
+
+        std::vector<TransferPlanner::Entry> entries;
+        std::vector<TransferPlanner::PlannedItem> planned;
+        for (const auto share : capacity_shares) {
+            struct Result {
+                double ns = 0.0;
+                std::size_t stacks = 0;
+                double weight = 0.0;
+                double value = 0.0;
+            };
+            Result results[2];
+            for (const auto selection : {TransferPlanner::Selection::kGreedy, TransferPlanner::Selection::kValueDensity}) {
+                const TransferPlanner::Request request{.remaining_capacity = matching_weight * share, .selection = selection};
+                auto& result = results[static_cast<std::size_t>(selection)];
+                result.ns = BestNanoseconds(a_options.runs, [&]() {
+                    TransferTrace::Filter(snapshot, request, entries);
+                    TransferPlanner::Plan(entries, request, planned);
+                });
+                result.stacks = planned.size();
+                for (const auto& [entry_index, count] : planned) {
+                    result.weight += static_cast<double>(entries[entry_index].weight) * count;
+                    result.value += static_cast<double>(entries[entry_index].value) * count;
+                }
+            }
+            const auto& [greedy, density] = results;
+            std::printf("{\"suite\":\"selection\",\"entries\":%zu,\"capacity\":%.1f,\"capacity_share\":%.2f,"
+                        "\"greedy_ns\":%.1f,\"greedy_stacks\":%zu,\"greedy_weight\":%.1f,\"greedy_value\":%.0f,"
+                        "\"density_ns\":%.1f,\"density_stacks\":%zu,\"density_weight\":%.1f,\"density_value\":%.0f,"
+                        "\"density_gain\":%.3f}\n",
+                        ENTRIES, matching_weight * share, share, greedy.ns, greedy.stacks, greedy.weight, greedy.value, density.ns,
+                        density.stacks, density.weight, density.value, greedy.value > 0.0 ? density.value / greedy.value : 0.0);
+        }
+        return true;
+    }
+
+    // ---- loader: reading and tokenizing generated category folders ----
+
+    // A category file as the shared packs write them: mostly plugin-local ids, some full ids, editor ids, rules,
+    // comments and blank lines
+    std::string MakeCategoryFile(const std::size_t a_lines, std::mt19937& a_random) {
+        constexpr const char* plugins[] = {"Skyrim.esm", "Update.esm", "Dawnguard.esm", "HearthFires.esm", "Dragonborn.esm",
+                                           "CACO.esp", "Ordinator - Perks of Skyrim.esp", "Hunterborn.esp"};
+        std::uniform_int_distribution<std::uint32_t> kind(0, 99);
+        std::uniform_int_distribution<std::uint32_t> plugin(0, std::size(plugins) - 1);
+        std::uniform_int_distribution<std::uint32_t> local_id(0x800, 0xFFFFFF);
+
+        std::string contents;
+        char line[128];
+        for (std::size_t i = 0; i < a_lines; ++i) {
+            const auto roll = kind(a_random);
+            if (roll < 70) {
+                std::snprintf(line, sizeof(line), "0x%X~%s\n", local_id(a_random), plugins[plugin(a_random)]);
+            } else if (roll < 80) {
+                std::snprintf(line, sizeof(line), "0x%08X\n", local_id(a_random));
+            } else if (roll < 92) {
+                std::snprintf(line, sizeof(line), "  GeneratedEditorID%06u  \n", local_id(a_random) % 1000000);
+            } else if (roll < 94) {
+                std::snprintf(line, sizeof(line), "rule: type=Misc weight<%u.5 !keyword=VendorItemGem\n", kind(a_random) % 5);
+            } else if (roll < 98) {
+                std::snprintf(line, sizeof(line), "; generated comment %zu\n", i);
+            } else {
+                std::snprintf(line, sizeof(line), "\n");
+            }
+            contents += line;
+        }
+        return contents;
+    }
+
+    bool RunLoaderSuite(const Options& a_options) {
+        constexpr std::size_t FILES_PER_CATEGORY = 4;
+        const auto root = std::filesystem::temp_directory_path() / ("transfer-bench-" + std::to_string(a_options.seed));
+        std::error_code ec;
+        std::filesystem::remove_all(root, ec);
+
+        std::mt19937 random(a_options.seed);
+        const auto file_count = FormListParser::kCategoryFolders.size() * FILES_PER_CATEGORY;
+        std::vector<std::filesystem::path> files;
+        std::size_t bytes = 0;
+        for (const auto folder : FormListParser::kCategoryFolders) {
+            std::filesystem::create_directories(root / folder);
+            for (std::size_t i = 0; i < FILES_PER_CATEGORY; ++i) {
+                auto& path = files.emplace_back(root / folder / ("generated_" + std::to_string(i) + ".txt"));
+                const auto contents = MakeCategoryFile(a_options.lines / file_count, random);
+                bytes += contents.size();
+                if (std::FILE* file = std::fopen(path.string().c_str(), "wb")) {
+                    std::fwrite(contents.data(), 1, contents.size(), file);
+                    std::fclose(file);
+                } else {
+                    std::fprintf(stderr, "error: cannot write %s\n", path.string().c_str());
+                    return false;
+                }
+            }
+        }
+
+        // what the plugin does before kDataLoaded, and then per chunk on the task pool before resolving
+        std::string buffer;
+        std::size_t entries = 0;
+        std::size_t tokens[5] = {};
+        const auto ns = BestNanoseconds(a_options.runs, [&]() {
+            entries = 0;
+            std::ranges::fill(tokens, 0);
+            for (const auto& path : files) {
+                if (!FormListParser::ReadFile(path, buffer)) continue;
+                FormListParser::ForEachEntry(buffer, [&](const std::string_view a_entry, std::uint32_t) {
+                    ++entries;
+                    ++tokens[static_cast<std::size_t>(FormListParser::ParseToken(a_entry).kind)];
+                });
+            }
+        });
+        std::printf("{\"suite\":\"loader\",\"files\":%zu,\"lines\":%zu,\"bytes\":%zu,\"entries\":%zu,\"rules\":%zu,\"ms\":%.3f,"
+                    "\"lines_per_s\":%.0f,\"mb_per_s\":%.1f}\n",
+                    files.size(), a_options.lines / file_count * file_count, bytes, entries,
+                    tokens[static_cast<std::size_t>(FormListParser::Token::Kind::kRule)], ns / 1e6,
+                    static_cast<double>(a_options.lines / file_count * file_count) / (ns / 1e9),
+                    static_cast<double>(bytes) / (ns / 1e3));
+
+        std::filesystem::remove_all(root, ec);
+        return true;
+    }
+
+    // ---- formset: ConcurrentFormSet under concurrent lookups and inserts ----
+
+    // Readers look up random ids on every thread while one writer inserts ids in batches, as the keyword caches
+    // fill while the pool classifies forms. Every reader checks what it sees: no id that was never inserted, and
+    // no id lost again once found. After the writer is done every id must be there. Lookups per second are
+    // reported for the write phase, and for a mutex-guarded std::unordered_set doing the same as a reference.
+    bool RunFormSetSuite(const Options& a_options) {
+        constexpr FormID INSERTED = 200000;  // ids 1..INSERTED are inserted; readers also ask for as many that never are
+        bool passed = true;
+
+        for (const auto threads : ThreadCounts(a_options.threads)) {
+            ConcurrentFormSet set;
+            std::atomic<bool> writing{true};
+            std::atomic<std::uint64_t> lookups{0};
+            std::atomic<std::uint64_t> errors{0};
+
+            const auto read = [&](const std::uint32_t a_seed) {
+                std::mt19937 random(a_seed);
+                std::uniform_int_distribution<FormID> id(1, 2 * INSERTED);
+                std::vector<FormID> found;  // a sample of hits, asked for again later
+                std::uint64_t count = 0;
+                while (writing.load(std::memory_order_relaxed)) {
+                    for (int i = 0; i < 256; ++i) {
+                        const auto formid = id(random);
+                        if (set.contains(formid)) {
+                            if (formid > INSERTED) errors.fetch_add(1, std::memory_order_relaxed);
+                            if (found.size() < 4096) found.push_back(formid);
+                        }
+                    }
+                    count += 256;
+                    for (const auto formid : found) {
+                        if (!set.contains(formid)) errors.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    count += found.size();
+                }
+                lookups.fetch_add(count, std::memory_order_relaxed);
+            };
+
+            std::vector<std::thread> readers;
+            for (std::size_t i = 0; i < threads; ++i) {
+                readers.emplace_back(read, a_options.seed + static_cast<std::uint32_t>(i));
+            }
+            const auto start = Clock::now();
+            std::mt19937 random(a_options.seed);
+            std::vector<FormID> order(INSERTED);
+            for (FormID i = 0; i < INSERTED; ++i) order[i] = i + 1;
+            std::ranges::shuffle(order, random);
+            for (const auto formid : order) {
+                set.insert(formid);
+            }
+            set.Publish();
+            const auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            writing = false;
+            for (auto& reader : readers) reader.join();
+
+            std::size_t missing = 0;
+            for (FormID formid = 1; formid <= 2 * INSERTED; ++formid) {
+                missing += set.contains(formid) != (formid <= INSERTED);
+            }
+            const bool ok = errors == 0 && missing == 0 && set.size() == INSERTED;
+            passed &= ok;
+
+            // the same load against the structure it replaced, made thread-safe the simplest way
+            std::unordered_set<FormID> locked_set;
+            std::mutex mutex;
+            std::atomic<std::uint64_t> locked_lookups{0};
+            std::atomic<std::uint64_t> locked_hits{0};
+            writing = true;
+            readers.clear();
+            for (std::size_t i = 0; i < threads; ++i) {
+                readers.emplace_back([&, i]() {
+                    std::mt19937 reader_random(a_options.seed + static_cast<std::uint32_t>(i));
+                    std::uniform_int_distribution<FormID> id(1, 2 * INSERTED);
+                    std::uint64_t count = 0;
+                    std::uint64_t hits = 0;
+                    while (writing.load(std::memory_order_relaxed)) {
+                        std::lock_guard lock(mutex);
+                        for (int j = 0; j < 256; ++j) hits += locked_set.contains(id(reader_random));
+                        count += 256;
+                    }
+                    locked_lookups.fetch_add(count, std::memory_order_relaxed);
+                    locked_hits.fetch_add(hits, std::memory_order_relaxed);  // keeps the lookups from being dropped
+                });
+            }
+            const auto locked_start = Clock::now();
+            for (const auto formid : order) {
+                std::lock_guard lock(mutex);
+                locked_set.insert(formid);
+            }
+            const auto locked_seconds = std::chrono::duration<double>(Clock::now() - locked_start).count();
+            writing = false;
+            for (auto& reader : readers) reader.join();
+
+            std::printf("{\"suite\":\"formset\",\"readers\":%zu,\"inserted\":%u,\"lookups_per_s\":%.0f,"
+                        "\"locked_lookups_per_s\":%.0f,\"insert_ms\":%.2f,\"locked_insert_ms\":%.2f,\"errors\":%llu,"
+                        "\"missing\":%zu,\"passed\":%s}\n",
+                        threads, INSERTED, static_cast<double>(lookups.load()) / seconds,
+                        static_cast<double>(locked_lookups.load()) / locked_seconds, seconds * 1e3, locked_seconds * 1e3,
+                        static_cast<unsigned long long>(errors.load()), missing, ok ? "true" : "false");
+        }
+        return passed;
+    }
+
+    // ---- kernels: per-item cost of the category predicates, type-erased against compiled per category ----
+
+    constexpr const char* item_type_names[] = {"weapon",     "ammo",        "armor_strict", "jewelry",   "shield",  "clothing", "poison",
+                                               "potion",     "scroll",      "food",         "raw_food",  "cooked_food", "sweets",
+                                               "drinks",     "ingredient",  "book_all",     "book_spell", "book_skill", "book_recipe",
+                                               "book_strict", "key",        "misc_all",     "soul_gem",  "ores",    "gems",
+                                               "leather_pelts", "building_materials"};
+    static_assert(std::size(item_type_names) == kNone, "one name per ItemTypes value");
+
+    struct KernelItem {
+        RE::TESBoundObject* object = nullptr;
+        std::int32_t count = 0;
+        float weight = 0.f;
+    };
+
+    // Before: GetFilterFunc built a std::function for the category on every transfer, and the loop called every
+    // item's predicate through it. Here it wraps the same predicates the plugin compiles in (IsOfItemType).
+    using FilterFunc = std::function<bool(RE::TESBoundObject*)>;
+
+    template <std::size_t... I>
+    constexpr auto MakeFilterFactories(std::index_sequence<I...>) {
+        return std::array<FilterFunc (*)(const FormLists::Snapshot&), sizeof...(I)>{+[](const FormLists::Snapshot& a_lists) -> FilterFunc {
+            return [&a_lists](RE::TESBoundObject* a_obj) { return IsOfItemType<static_cast<ItemTypes>(I)>(a_obj, a_lists); };
+        }...};
+    }
+    constexpr auto filter_factories = MakeFilterFactories(std::make_index_sequence<kNone>{});
+
+    float TransferWithFunction(const std::vector<KernelItem>& a_items, const ItemTypes a_type, const FormLists::Snapshot& a_lists) {
+        const auto filter = filter_factories[a_type](a_lists);
+        float weight = 0.f;
+        for (const auto& [object, count, item_weight] : a_items) {
+            if (filter(object)) weight += item_weight * static_cast<float>(count);
+        }
+        return weight;
+    }
+
+    // After: one loop per category with its predicate inlined, picked from a table built once
+    template <ItemTypes T>
+    float TransferKernelFor(const std::vector<KernelItem>& a_items, const FormLists::Snapshot& a_lists) {
+        float weight = 0.f;
+        for (const auto& [object, count, item_weight] : a_items) {
+            if (IsOfItemType<T>(object, a_lists)) weight += item_weight * static_cast<float>(count);
+        }
+        return weight;
+    }
+
+    // What the plugin's kernels do now: one probe of the snapshot's category index, then a bit test
+    template <ItemTypes T>
+    float TransferIndexedFor(const std::vector<KernelItem>& a_items, const FormLists::Snapshot& a_lists) {
+        float weight = 0.f;
+        for (const auto& [object, count, item_weight] : a_items) {
+            if (FormLists::GetCategoryMask(object, a_lists) & ItemTypeBit(T)) weight += item_weight * static_cast<float>(count);
+        }
+        return weight;
+    }
+
+    using KernelFunc = float (*)(const std::vector<KernelItem>&, const FormLists::Snapshot&);
+
+    template <std::size_t... I>
+    constexpr auto MakeTransferKernels(std::index_sequence<I...>) {
+        return std::array<KernelFunc, sizeof...(I)>{&TransferKernelFor<static_cast<ItemTypes>(I)>...};
+    }
+    template <std::size_t... I>
+    constexpr auto MakeIndexedKernels(std::index_sequence<I...>) {
+        return std::array<KernelFunc, sizeof...(I)>{&TransferIndexedFor<static_cast<ItemTypes>(I)>...};
+    }
+    constexpr auto transfer_kernels = MakeTransferKernels(std::make_index_sequence<kNone>{});
+    constexpr auto indexed_kernels = MakeIndexedKernels(std::make_index_sequence<kNone>{});
+
+    // Loads a stand-in game: the vendor keywords, one form of every inventory type and flavour the predicates tell
+    // apart (with and without keywords, in and out of the TXT lists), and snapshot lists naming some of them
+    std::vector<RE::TESBoundObject*> MakeGameForms(const std::size_t a_count, std::mt19937& a_random, FormLists::Snapshot& a_lists) {
+        constexpr FormID vendor_keyword_ids[] = {0x914ed, 0x914ec, 0x914ea, 0xA0E56, 0x6BBE9, 0xF5CB0};
+        for (const auto formid : vendor_keyword_ids) new RE::BGSKeyword(formid);
+        FormLists::LoadKeywords();
+        const auto& keywords = FormLists::vendorItemKeywords;  // gem, ore, hide, raw food, jewelry, recipe
+
+        std::vector<FormID> cooked_food, sweets, drinks, building_materials;
+        std::bernoulli_distribution coin(0.5);
+        std::bernoulli_distribution rare(0.1);
+        std::bernoulli_distribution runtime_form(0.02);
+        std::uniform_int_distribution<int> kind(0, 13);
+
+        std::vector<RE::TESBoundObject*> forms;
+        forms.reserve(a_count);
+        FormID next_id = 0x01000800;
+        for (std::size_t i = 0; i < a_count; ++i) {
+            // a few forms were created at runtime (player potions, tempered copies)
+            const auto formid = runtime_form(a_random) ? 0xFF000000 | next_id++ : next_id++;
+            switch (kind(a_random)) {
+                case 0:
+                    forms.push_back(new RE::TESObjectWEAP(formid));
+                    break;
+                case 1:
+                case 2: {
+                    const auto armor = new RE::TESObjectARMO(formid);
+                    armor->armorType = static_cast<RE::BGSBipedObjectForm::ArmorType>(kind(a_random) % 3);
+                    armor->slots = rare(a_random) ? RE::BGSBipedObjectForm::kShieldSlot : 1u << 2;
+                    if (rare(a_random)) armor->keywords.push_back(keywords[4]);
+                    forms.push_back(armor);
+                    break;
+                }
+                case 3:
+                case 4: {
+                    const auto alchemy = new RE::AlchemyItem(formid);
+                    alchemy->food = coin(a_random);
+                    alchemy->poison = !alchemy->food && coin(a_random);
+                    if (alchemy->food) {
+                        if (rare(a_random)) alchemy->keywords.push_back(keywords[3]);
+                        auto& list = kind(a_random) % 3 == 0 ? cooked_food : kind(a_random) % 2 ? sweets : drinks;
+                        if (coin(a_random)) list.push_back(formid);
+                    }
+                    forms.push_back(alchemy);
+                    break;
+                }
+                case 5:
+                case 6: {
+                    const auto book = new RE::TESObjectBOOK(formid);
+                    book->teaches_skill = rare(a_random);
+                    book->teaches_spell = !book->teaches_skill && rare(a_random);
+                    if (rare(a_random)) book->keywords.push_back(keywords[5]);
+                    forms.push_back(book);
+                    break;
+                }
+                case 7:
+                case 8:
+                case 9: {
+                    const auto misc = new RE::TESObjectMISC(formid, RE::FormType::Misc);
+                    if (coin(a_random)) misc->keywords.push_back(keywords[kind(a_random) % 3]);
+                    if (rare(a_random)) building_materials.push_back(formid);
+                    forms.push_back(misc);
+                    break;
+                }
+                default: {
+                    constexpr RE::FormType other_types[] = {RE::FormType::Ammo,      RE::FormType::Scroll,  RE::FormType::Ingredient,
+                                                            RE::FormType::KeyMaster, RE::FormType::SoulGem, RE::FormType::Light};
+                    forms.push_back(new RE::TESObjectMISC(formid, other_types[static_cast<std::size_t>(kind(a_random)) % std::size(other_types)]));
+                    break;
+                }
+            }
+        }
+
+        a_lists.cooked_food = FrozenFormSet(std::move(cooked_food));
+        a_lists.sweets = FrozenFormSet(std::move(sweets));
+        a_lists.drinks = FrozenFormSet(std::move(drinks));
+        a_lists.building_materials = FrozenFormSet(std::move(building_materials));
+        // runtime forms are left out of the index, so GetCategoryMask classifies them on every probe, as in game
+        FormLists::BuildCategoryIndex();
+        FormLists::BuildSnapshotIndex(a_lists);
+        for (const auto form : forms) {
+            if (form->IsDynamicForm()) a_lists.category_index.erase(form->GetFormID());
+        }
+        return forms;
+    }
+
+    // One stand-in game per process, for every suite that needs one: its forms register with it and live until exit
+    struct StandInGame {
+        FormLists::Snapshot lists;
+        std::vector<RE::TESBoundObject*> forms;
+    };
+
+    const StandInGame& GetStandInGame(const Options& a_options) {
+        static const auto game = [&]() {
+            constexpr std::size_t FORMS = 10000;
+            StandInGame game;
+            std::mt19937 random(a_options.seed);
+            game.forms = MakeGameForms(FORMS, random, game.lists);
+            return game;
+        }();
+        return game;
+    }
+
+    // The plugin's own predicates and category index run on stand-in forms (tools/GameShim.h), so casts, keyword
+    // searches, list lookups and the keyword caches cost what they cost in the plugin; only the forms are synthetic.
+    bool RunKernelSuite(const Options& a_options) {
+        const auto& [lists, forms] = GetStandInGame(a_options);
+        std::mt19937 random(a_options.seed);
+        std::uniform_int_distribution<std::int32_t> count(1, 20);
+        std::lognormal_distribution<float> weight(-1.0f, 1.5f);
+        std::vector<KernelItem> items;
+        items.reserve(forms.size());
+        for (const auto form : forms) {
+            items.push_back({.object = form, .count = count(random), .weight = weight(random)});
+        }
+
+        bool passed = true;
+        for (std::size_t i = 0; i < kNone; ++i) {
+            const auto item_type = static_cast<ItemTypes>(i);
+            float function_weight = 0.f;
+            float kernel_weight = 0.f;
+            float indexed_weight = 0.f;
+            const auto function_ns = BestNanoseconds(a_options.runs, [&]() { function_weight = TransferWithFunction(items, item_type, lists); });
+            const auto kernel_ns = BestNanoseconds(a_options.runs, [&]() { kernel_weight = transfer_kernels[i](items, lists); });
+            const auto indexed_ns = BestNanoseconds(a_options.runs, [&]() { indexed_weight = indexed_kernels[i](items, lists); });
+            const bool same = function_weight == kernel_weight && kernel_weight == indexed_weight;
+            passed &= same;
+            std::printf("{\"suite\":\"kernels\",\"item_type\":\"%s\",\"items\":%zu,\"function_ns_per_item\":%.3f,"
+                        "\"kernel_ns_per_item\":%.3f,\"indexed_ns_per_item\":%.3f,\"speedup\":%.2f,\"same_result\":%s}\n",
+                        item_type_names[i], items.size(), function_ns / items.size(), kernel_ns / items.size(), indexed_ns / items.size(), function_ns / kernel_ns,
+                        same ? "true" : "false");
+        }
+        return passed;
+    }
+
+    // ---- parser: one large category file, line by line against the shared scanner ----
+
+    // Stands in for what an entry resolves to in the game: its id, or a hash of its editor id
+    FormID StandInFormID(const std::string_view a_entry) {
+        const auto token = FormListParser::ParseToken(a_entry);
+        return token.id != 0 ? token.id : static_cast<FormID>(FormListParser::HashBytes(token.name.empty() ? a_entry : token.name));
+    }
+
+    std::string TrimCopy(const std::string& a_str) {
+        const auto start = std::ranges::find_if(a_str, [](const unsigned char ch) { return !std::isspace(ch); });
+        const auto end = std::find_if(a_str.rbegin(), a_str.rend(), [](const unsigned char ch) { return !std::isspace(ch); }).base();
+        return start < end ? std::string(start, end) : std::string();
+    }
+
+    // Before: std::ifstream and std::getline, a trimmed copy of every line, results in a node-based std::set
+    std::size_t ParseWithGetline(const std::filesystem::path& a_path) {
+        std::ifstream file(a_path);
+        std::set<FormID> forms;
+        std::string line;
+        while (std::getline(file, line)) {
+            line = TrimCopy(line);
+            if (line.empty() || line[0] == '#' || line[0] == ';') continue;
+            forms.insert(StandInFormID(line));
+        }
+        return forms.size();
+    }
+
+    // After: the whole file in one read, lines scanned in place as string_views, results sorted once
+    std::size_t ParseWithScanner(const std::filesystem::path& a_path, std::string& a_buffer, std::vector<FormID>& a_forms) {
+        a_forms.clear();
+        if (!FormListParser::ReadFile(a_path, a_buffer)) return 0;
+        FormListParser::ForEachEntry(a_buffer, [&](const std::string_view a_entry, std::uint32_t) { a_forms.push_back(StandInFormID(a_entry)); });
+        std::ranges::sort(a_forms);
+        const auto [first, last] = std::ranges::unique(a_forms);
+        a_forms.erase(first, last);
+        return a_forms.size();
+    }
+
+    bool RunParserSuite(const Options& a_options) {
+        const auto path = std::filesystem::temp_directory_path() / ("transfer-bench-" + std::to_string(a_options.seed) + ".txt");
+        std::mt19937 random(a_options.seed);
+        const auto contents = MakeCategoryFile(a_options.lines, random);
+        if (std::FILE* file = std::fopen(path.string().c_str(), "wb")) {
+            std::fwrite(contents.data(), 1, contents.size(), file);
+            std::fclose(file);
+        } else {
+            std::fprintf(stderr, "error: cannot write %s\n", path.string().c_str());
+            return false;
+        }
+
+        std::size_t getline_forms = 0;
+        std::size_t scanner_forms = 0;
+        std::string buffer;
+        std::vector<FormID> forms;
+        const auto getline_ns = BestNanoseconds(a_options.runs, [&]() { getline_forms = ParseWithGetline(path); });
+        const auto scanner_ns = BestNanoseconds(a_options.runs, [&]() { scanner_forms = ParseWithScanner(path, buffer, forms); });
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+
+        const bool same = getline_forms == scanner_forms;
+        std::printf("{\"suite\":\"parser\",\"lines\":%zu,\"bytes\":%zu,\"forms\":%zu,\"getline_ms\":%.3f,\"scanner_ms\":%.3f,"
+                    "\"scanner_lines_per_s\":%.0f,\"scanner_mb_per_s\":%.1f,\"speedup\":%.2f,\"same_result\":%s}\n",
+                    a_options.lines, contents.size(), scanner_forms, getline_ns / 1e6, scanner_ns / 1e6,
+                    static_cast<double>(a_options.lines) / (scanner_ns / 1e9), static_cast<double>(contents.size()) / (scanner_ns / 1e3),
+                    getline_ns / scanner_ns, same ? "true" : "false");
+        return same;
+    }
+
+    // ---- frozen: FrozenFormSet against the std::unordered_set it replaced ----
+
+    // Counts the bytes a container holds on the heap
+    std::size_t g_allocatedBytes = 0;
+
+    template <typename T>
+    struct CountingAllocator {
+        using value_type = T;
+
+        CountingAllocator() noexcept = default;
+        template <typename U>
+        CountingAllocator(const CountingAllocator<U>&) noexcept {}
+
+        [[nodiscard]] T* allocate(const std::size_t a_count) {
+            g_allocatedBytes += a_count * sizeof(T);
+            return std::allocator<T>{}.allocate(a_count);
+        }
+        void deallocate(T* a_ptr, const std::size_t a_count) noexcept {
+            g_allocatedBytes -= a_count * sizeof(T);
+            std::allocator<T>{}.deallocate(a_ptr, a_count);
+        }
+
+        template <typename U>
+        bool operator==(const CountingAllocator<U>&) const noexcept { return true; }
+    };
+
+    // Sizes of the merged category lists, up to a 200k-entry shared pack. Lookups ask for listed and unlisted ids
+    // alike, as the category filter does for every inventory item.
+    bool RunFrozenSuite(const Options& a_options) {
+        constexpr std::size_t sizes[] = {1000, 10000, 50000, 200000};
+        constexpr std::size_t LOOKUPS = 1 << 16;
+        using NodeSet = std::unordered_set<FormID, std::hash<FormID>, std::equal_to<>, CountingAllocator<FormID>>;
+
+        bool passed = true;
+        std::mt19937 random(a_options.seed);
+        for (const auto size : sizes) {
+            // plugin-local ids spread over a few dozen plugins, as real lists are
+            std::uniform_int_distribution<FormID> plugin(0, 40);
+            std::uniform_int_distribution<FormID> local_id(0x800, 0xFFFFFF);
+            std::vector<FormID> forms(size);
+            for (auto& formid : forms) formid = (plugin(random) << 24) | local_id(random);
+
+            std::vector<FormID> queries(LOOKUPS);
+            std::uniform_int_distribution<std::size_t> listed(0, size - 1);
+            for (std::size_t i = 0; i < LOOKUPS; ++i) {
+                queries[i] = i % 2 ? forms[listed(random)] : (plugin(random) << 24) | local_id(random);
+            }
+
+            g_allocatedBytes = 0;
+            const NodeSet node_set(forms.begin(), forms.end());
+            const auto node_bytes = g_allocatedBytes;
+            const FrozenFormSet frozen(forms);
+
+            std::size_t node_hits = 0;
+            std::size_t frozen_hits = 0;
+            const auto node_ns = BestNanoseconds(a_options.runs, [&]() {
+                node_hits = 0;
+                for (const auto formid : queries) node_hits += node_set.contains(formid);
+            });
+            const auto frozen_ns = BestNanoseconds(a_options.runs, [&]() {
+                frozen_hits = 0;
+                for (const auto formid : queries) frozen_hits += frozen.contains(formid);
+            });
+
+            const bool same = node_hits == frozen_hits && node_set.size() == frozen.size();
+            passed &= same;
+            std::printf("{\"suite\":\"frozen\",\"forms\":%zu,\"node_set_bytes\":%zu,\"frozen_bytes\":%zu,\"bytes_saved\":%zu,"
+                        "\"node_set_mlookups_per_s\":%.1f,\"frozen_mlookups_per_s\":%.1f,\"same_result\":%s}\n",
+                        frozen.size(), node_bytes, frozen.memory_usage(), node_bytes - std::min(node_bytes, frozen.memory_usage()),
+                        LOOKUPS / (node_ns / 1e3), LOOKUPS / (frozen_ns / 1e3), same ? "true" : "false");
+        }
+        return passed;
+    }
+
+    // ---- allocs: heap allocations of a transfer pass once the scratch pools are warm ----
+
+    // operator new calls on threads with t_countAllocations set; the replacements are at the end of this file
+    std::atomic<std::uint64_t> g_allocations{0};
+    thread_local bool t_countAllocations = false;
+
+    struct PlannedObject {
+        RE::TESBoundObject* object = nullptr;
+        std::int32_t count = 0;
+    };
+
+    // The game-free part of one transfer as the plugin runs it (TransferItems in src/Utils.cpp, MakePlan in
+    // src/TransferWorker.cpp): buffers from the scratch pools, the category index, the planner, the planned items,
+    // and the buffers handed back. Returns the number of planned stacks.
+    std::size_t RunTransferPass(const std::vector<KernelItem>& a_items, const std::uint32_t a_typeMask, const FormLists::Snapshot& a_lists,
+                                const TransferPlanner::Selection a_selection) {
+        auto entries = Scratch::Acquire<TransferPlanner::Entry>();
+        auto objects = Scratch::Acquire<RE::TESBoundObject*>();
+        for (const auto& [object, count, weight] : a_items) {
+            const auto mask = FormLists::GetCategoryMask(object, a_lists);
+            if ((mask & FormLists::kExcludedBit) || !(mask & a_typeMask)) continue;
+            entries.push_back({.formid = object->GetFormID(), .count = count, .weight = weight, .value = count * 7});
+            objects.push_back(object);
+        }
+
+        thread_local std::vector<TransferPlanner::PlannedItem> planned;
+        TransferPlanner::Plan(entries, {.remaining_capacity = 300.f, .selection = a_selection}, planned);
+        auto items = Scratch::Acquire<PlannedObject>();
+        items.reserve(planned.size());
+        for (const auto& [entry_index, count] : planned) {
+            items.push_back({.object = objects[entry_index], .count = count});
+        }
+        const auto stacks = items.size();
+
+        Scratch::Release(std::move(entries));
+        Scratch::Release(std::move(objects));
+        Scratch::Release(std::move(items));
+        return stacks;
+    }
+
+    // Every category and a few multi-category masks, with both selections. One round warms the pools; the rounds
+    // after it must not allocate at all.
+    bool RunAllocationSuite(const Options& a_options) {
+        constexpr std::size_t ROUNDS = 20;
+        const auto& [lists, forms] = GetStandInGame(a_options);
+        std::mt19937 random(a_options.seed);
+        std::uniform_int_distribution<std::int32_t> count(1, 20);
+        std::lognormal_distribution<float> weight(-1.0f, 1.5f);
+        std::vector<KernelItem> items;
+        items.reserve(forms.size());
+        for (const auto form : forms) {
+            items.push_back({.object = form, .count = count(random), .weight = weight(random)});
+        }
+
+        std::vector<std::uint32_t> masks;
+        for (std::size_t i = 0; i < kNone; ++i) masks.push_back(ItemTypeBit(static_cast<ItemTypes>(i)));
+        masks.push_back(ItemTypeBit(kWeapon) | ItemTypeBit(kArmorStrict) | ItemTypeBit(kAmmo));
+        masks.push_back(ItemTypeBit(kGems) | ItemTypeBit(kOres) | ItemTypeBit(kLeatherNPelts) | ItemTypeBit(kBuildingMaterials));
+        constexpr TransferPlanner::Selection selections[] = {TransferPlanner::Selection::kGreedy, TransferPlanner::Selection::kValueDensity};
+
+        const auto run_round = [&]() {
+            std::size_t stacks = 0;
+            for (const auto mask : masks) {
+                for (const auto selection : selections) stacks += RunTransferPass(items, mask, lists, selection);
+            }
+            return stacks;
+        };
+
+        g_allocations = 0;
+        t_countAllocations = true;
+        const auto warm_stacks = run_round();
+        const std::uint64_t warmup_allocations = g_allocations.exchange(0);
+        std::size_t steady_stacks = 0;
+        for (std::size_t round = 0; round < ROUNDS; ++round) steady_stacks += run_round();
+        t_countAllocations = false;
+        const std::uint64_t steady_allocations = g_allocations;
+
+        const auto passes = ROUNDS * masks.size() * std::size(selections);
+        const bool passed = steady_allocations == 0 && steady_stacks == warm_stacks * ROUNDS;
+        std::printf("{\"suite\":\"allocs\",\"items\":%zu,\"warmup_passes\":%zu,\"warmup_allocations\":%llu,\"passes\":%zu,"
+                    "\"allocations\":%llu,\"allocations_per_pass\":%.3f,\"same_result\":%s}\n",
+                    items.size(), masks.size() * std::size(selections), static_cast<unsigned long long>(warmup_allocations), passes,
+                    static_cast<unsigned long long>(steady_allocations), static_cast<double>(steady_allocations) / static_cast<double>(passes),
+                    passed ? "true" : "false");
+        return passed;
+    }
+
+    // ---- pool: TaskPool scaling from one thread up ----
+
+    // Digest of one chunk of a_bytes; heavy enough per byte that a chunk stands in for parsing one list file
+    std::uint64_t HashChunk(const std::string_view a_bytes, const std::size_t a_index, const std::size_t a_chunkSize) {
+        const auto chunk = a_bytes.substr(a_index * a_chunkSize, a_chunkSize);
+        std::uint64_t digest = FormListParser::HashBytes(chunk);
+        for (int round = 0; round < 3; ++round) digest = FormListParser::HashBytes(chunk, digest);
+        return digest;
+    }
+
+    // The same 4 MB of work split into few large tasks, as the list loader hands out files, and into many small
+    // ones, where the pool's own overhead shows. Speedup and efficiency are against the pool without workers,
+    // which runs everything on the calling thread.
+    bool RunPoolSuite(const Options& a_options) {
+        constexpr std::size_t TOTAL_BYTES = std::size_t{4} << 20;
+        constexpr std::pair<const char*, std::size_t> granularities[] = {{"coarse", 64}, {"fine", 16384}};
+
+        std::string bytes(TOTAL_BYTES, '\0');
+        std::mt19937 random(a_options.seed);
+        for (auto& byte : bytes) byte = static_cast<char>(random());
+
+        bool passed = true;
+        for (const auto& [granularity, task_count] : granularities) {
+            const auto chunk_size = TOTAL_BYTES / task_count;
+            std::vector<std::uint64_t> expected(task_count);
+            for (std::size_t i = 0; i < task_count; ++i) expected[i] = HashChunk(bytes, i, chunk_size);
+
+            double serial_ns = 0.0;
+            for (const auto threads : ThreadCounts(a_options.threads)) {
+                // one pool per thread count; like the plugin's, it is never destroyed
+                auto& pool = *new TaskPool(threads - 1);
+                std::vector<std::uint64_t> digests(task_count);
+                const auto ns = BestNanoseconds(a_options.runs, [&]() {
+                    pool.ParallelFor(task_count, [&](const std::size_t a_index) { digests[a_index] = HashChunk(bytes, a_index, chunk_size); });
+                });
+                if (threads == 1) serial_ns = ns;
+
+                const bool same = digests == expected;
+                passed &= same;
+                const auto speedup = serial_ns / ns;
+                std::printf("{\"suite\":\"pool\",\"granularity\":\"%s\",\"tasks\":%zu,\"threads\":%zu,\"ms\":%.3f,"
+                            "\"mb_per_s\":%.0f,\"speedup\":%.2f,\"efficiency\":%.2f,\"same_result\":%s}\n",
+                            granularity, task_count, threads, ns / 1e6, static_cast<double>(TOTAL_BYTES) / (ns / 1e3), speedup,
+                            speedup / static_cast<double>(threads), same ? "true" : "false");
+            }
+        }
+        return passed;
+    }
+
+    struct Suite {
+        std::string_view name;
+        bool (*run)(const Options&);  // false if a check failed
+    };
+    constexpr Suite suites[] = {{"planner", RunPlannerSuite},
+                                {"selection", RunSelectionSuite},
+                                {"loader", RunLoaderSuite},
+                                {"formset", RunFormSetSuite},
+                                {"kernels", RunKernelSuite},
+                                {"parser", RunParserSuite},
+                                {"frozen", RunFrozenSuite},
+                                {"allocs", RunAllocationSuite},
+                                {"pool", RunPoolSuite}};
+}
+
+int main(int a_argc, char** a_argv) {
+    Options options;
+    if (!ParseArguments(a_argc, a_argv, options)) {
+        std::fputs(USAGE, stderr);
+        return 2;
+    }
+    for (const auto& name : options.suites) {
+        if (std::ranges::find(suites, name, &Suite::name) == std::end(suites)) {
+            std::fprintf(stderr, "error: unknown suite %s\n", name.c_str());
+            std::fputs(USAGE, stderr);
+            return 2;
+        }
+    }
+
+    bool passed = true;
+    for (const auto& [name, run] : suites) {
+        if (options.suites.empty() || std::ranges::find(options.suites, name) != options.suites.end()) {
+            if (!run(options)) {
+                std::fprintf(stderr, "error: suite %.*s failed its checks\n", static_cast<int>(name.size()), name.data());
+                passed = false;
+            }
+            std::fflush(stdout);
+        }
+    }
+    return passed ? 0 : 1;
+}
+
+// Counting replacements of the global allocation functions for the allocs suite; the array, nothrow and sized forms
+// forward to these by default
+void* operator new(const std::size_t a_size) {
+    if (t_countAllocations) g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (const auto ptr = std::malloc(a_size ? a_size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* a_ptr) noexcept {
+    std::free(a_ptr);
+}
+
+void operator delete(void* a_ptr, std::size_t) noexcept {
+    std::free(a_ptr);
+}
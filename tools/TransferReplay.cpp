@@ -0,0 +1,212 @@
+// Replays transfer traces recorded in game (StartTransferRecording) through the category filter and the planner.
+// Reports the request stream, planning throughput and latency percentiles, and a digest of every plan made, so a
+// filter or planner change can be checked against real sessions: same digest, same transfers.
+#include "FormListParser.h"
+#include "TransferTrace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <optional>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr auto USAGE =
+        "usage: transfer-replay <trace.qittrace>... [options]\n"
+        "  --selection <greedy|density>   plan every snapshot with this selection instead of the recorded one\n"
+        "  --runs <n>                     replay the traces n times (default 3); throughput is the best run\n";
+
+    struct Options {
+        std::vector<std::filesystem::path> traces;
+        std::optional<TransferPlanner::Selection> selection;
+        std::size_t runs = 3;
+    };
+
+    bool ParseArguments(const int a_argc, char** a_argv, Options& a_options) {
+        for (int i = 1; i < a_argc; ++i) {
+            const std::string_view arg = a_argv[i];
+            if (arg == "--selection" && i + 1 < a_argc) {
+                const std::string_view value = a_argv[++i];
+                if (value == "greedy") a_options.selection = TransferPlanner::Selection::kGreedy;
+                else if (value == "density") a_options.selection = TransferPlanner::Selection::kValueDensity;
+                else return false;
+            } else if (arg == "--runs" && i + 1 < a_argc) {
+                const auto runs = std::atoi(a_argv[++i]);
+                if (runs <= 0) return false;
+                a_options.runs = static_cast<std::size_t>(runs);
+            } else if (!arg.starts_with("--")) {
+                a_options.traces.emplace_back(arg);
+            } else {
+                return false;
+            }
+        }
+        return !a_options.traces.empty();
+    }
+
+    struct Trace {
+        std::vector<TransferTrace::Request> requests;
+        std::vector<TransferTrace::Snapshot> snapshots;
+    };
+
+    bool LoadTrace(const std::filesystem::path& a_path, Trace& a_trace) {
+        std::string bytes;
+        if (!FormListParser::ReadFile(a_path, bytes)) {
+            std::fprintf(stderr, "error: cannot read %s\n", a_path.string().c_str());
+            return false;
+        }
+
+        TransferTrace::Reader reader(bytes);
+        std::string error;
+        if (!reader.ReadHeader(error)) {
+            std::fprintf(stderr, "error: %s: %s\n", a_path.string().c_str(), error.c_str());
+            return false;
+        }
+        TransferTrace::RecordKind kind{};
+        TransferTrace::Request request;
+        TransferTrace::Snapshot snapshot;
+        while (reader.Next(kind, request, snapshot, error)) {
+            if (kind == TransferTrace::RecordKind::kRequest) {
+                a_trace.requests.push_back(request);
+            } else {
+                a_trace.snapshots.push_back(std::move(snapshot));
+                snapshot = {};
+            }
+        }
+        if (!error.empty()) {
+            // what was read before the cut is still a valid session
+            std::fprintf(stderr, "warning: %s: %s, replaying the records before it\n", a_path.string().c_str(), error.c_str());
+        }
+        return true;
+    }
+
+    double Percentile(std::vector<double>& a_sorted, const double a_percentile) {
+        if (a_sorted.empty()) return 0.0;
+        const auto rank = static_cast<std::size_t>(std::ceil(a_percentile / 100.0 * static_cast<double>(a_sorted.size())));
+        return a_sorted[std::clamp<std::size_t>(rank, 1, a_sorted.size()) - 1];
+    }
+
+    void ReportRequests(const Trace& a_trace) {
+        std::map<std::pair<std::int32_t, std::int32_t>, std::size_t> pairs;
+        std::vector<double> gaps_ms;
+        for (std::size_t i = 0; i < a_trace.requests.size(); ++i) {
+            const auto& request = a_trace.requests[i];
+            ++pairs[{request.action, request.subtype}];
+            if (i > 0 && request.time_us >= a_trace.requests[i - 1].time_us) {
+                gaps_ms.push_back(static_cast<double>(request.time_us - a_trace.requests[i - 1].time_us) / 1000.0);
+            }
+        }
+        std::ranges::sort(gaps_ms);
+
+        std::printf("requests: %zu, %zu transfer passes (the rest were merged or dropped as no-ops)\n", a_trace.requests.size(),
+                    a_trace.snapshots.size());
+        if (!gaps_ms.empty()) {
+            std::printf("  time between requests (ms): p50 %.1f, p95 %.1f, min %.1f\n", Percentile(gaps_ms, 50), Percentile(gaps_ms, 95),
+                        gaps_ms.front());
+        }
+
+        std::vector<std::pair<std::size_t, std::pair<std::int32_t, std::int32_t>>> by_count;
+        for (const auto& [pair, count] : pairs) {
+            by_count.emplace_back(count, pair);
+        }
+        std::ranges::sort(by_count, std::greater{});
+        constexpr std::size_t MAX_LISTED = 10;
+        for (std::size_t i = 0; i < std::min(by_count.size(), MAX_LISTED); ++i) {
+            const auto& [count, pair] = by_count[i];
+            std::printf("  action %d, subtype %d: %zu\n", pair.first, pair.second, count);
+        }
+    }
+
+    struct RunResult {
+        std::vector<double> latencies_us;  // filter and plan of each snapshot
+        double seconds = 0.0;
+        std::size_t entries = 0;
+        std::size_t planned_stacks = 0;
+        std::int64_t planned_items = 0;
+        double planned_weight = 0.0;
+        std::int64_t planned_value = 0;
+        std::uint64_t digest = FormListParser::HashBytes({});
+    };
+
+    RunResult Replay(const Trace& a_trace, const Options& a_options) {
+        RunResult result;
+        result.latencies_us.reserve(a_trace.snapshots.size());
+        std::vector<TransferPlanner::Entry> entries;
+        std::vector<TransferPlanner::PlannedItem> planned;
+
+        const auto run_start = Clock::now();
+        for (const auto& snapshot : a_trace.snapshots) {
+            auto request = snapshot.request;
+            if (a_options.selection) request.selection = *a_options.selection;
+
+            const auto start = Clock::now();
+            TransferTrace::Filter(snapshot, request, entries);
+            TransferPlanner::Plan(entries, request, planned);
+            result.latencies_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+
+            result.entries += entries.size();
+            result.planned_stacks += planned.size();
+            for (const auto& [entry_index, count] : planned) {
+                const auto& entry = entries[entry_index];
+                result.planned_items += count;
+                result.planned_weight += static_cast<double>(entry.weight) * count;
+                result.planned_value += static_cast<std::int64_t>(entry.value) * count;
+                const std::uint32_t fields[] = {entry.formid, static_cast<std::uint32_t>(count)};
+                result.digest = FormListParser::HashBytes({reinterpret_cast<const char*>(fields), sizeof(fields)}, result.digest);
+            }
+            // an empty plan still counts, so dropping a whole transfer changes the digest
+            result.digest = FormListParser::HashBytes("|", result.digest);
+        }
+        result.seconds = std::chrono::duration<double>(Clock::now() - run_start).count();
+        return result;
+    }
+}
+
+int main(int a_argc, char** a_argv) {
+    Options options;
+    if (!ParseArguments(a_argc, a_argv, options)) {
+        std::fputs(USAGE, stderr);
+        return 2;
+    }
+
+    // several traces are replayed as one session, in the order given
+    Trace trace;
+    for (const auto& path : options.traces) {
+        if (!LoadTrace(path, trace)) return 1;
+    }
+    ReportRequests(trace);
+    if (trace.snapshots.empty()) return 0;
+
+    std::size_t items = 0;
+    for (const auto& snapshot : trace.snapshots) {
+        items += snapshot.items.size();
+    }
+
+    RunResult best;
+    std::vector<double> latencies_us;
+    for (std::size_t run = 0; run < options.runs; ++run) {
+        auto result = Replay(trace, options);
+        latencies_us.insert(latencies_us.end(), result.latencies_us.begin(), result.latencies_us.end());
+        if (run == 0 || result.seconds < best.seconds) {
+            best = std::move(result);
+        }
+    }
+    std::ranges::sort(latencies_us);
+
+    std::printf("replay: %zu passes over %zu inventory items (%zu matching), %zu runs, selection %s\n", trace.snapshots.size(), items,
+                best.entries, options.runs,
+                !options.selection                                             ? "as recorded"
+                : *options.selection == TransferPlanner::Selection::kGreedy ? "greedy"
+                                                                               : "value density");
+    std::printf("  throughput: %.0f passes/s, %.0f items/s (best run, %.2f ms)\n", static_cast<double>(trace.snapshots.size()) / best.seconds,
+                static_cast<double>(items) / best.seconds, best.seconds * 1e3);
+    std::printf("  latency (us): p50 %.2f, p95 %.2f, p99 %.2f, max %.2f\n", Percentile(latencies_us, 50), Percentile(latencies_us, 95),
+                Percentile(latencies_us, 99), latencies_us.back());
+    std::printf("  planned: %zu stacks, %lld items, weight %.1f, value %lld\n", best.planned_stacks,
+                static_cast<long long>(best.planned_items), best.planned_weight, static_cast<long long>(best.planned_value));
+    std::printf("  plan digest: %016llx\n", static_cast<unsigned long long>(best.digest));
+    return 0;
+}